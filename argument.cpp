@@ -63,6 +63,8 @@ void ArgumentParser::usage(char** argv)
     std::cerr << "    --help               print this menu\n";
     std::cerr << "    --path=<path>        sysfs location to monitor\n";
     std::cerr << "    --dev-path=<path>    device path to monitor\n";
+    std::cerr << "    --config-dir=<dir>   monitor every device with a\n";
+    std::cerr << "                         <dir>/<device path>.conf file\n";
     std::cerr << std::flush;
 }
 
@@ -70,11 +72,12 @@ const option ArgumentParser::options[] =
 {
     { "path",   required_argument,  NULL,   'p' },
     { "dev-path", required_argument,  NULL, 'o' },
+    { "config-dir", required_argument,  NULL, 'c' },
     { "help",   no_argument,        NULL,   'h' },
     { 0, 0, 0, 0},
 };
 
-const char* ArgumentParser::optionstr = "o:p:?h";
+const char* ArgumentParser::optionstr = "c:o:p:?h";
 
 const std::string ArgumentParser::true_string = "true";
 const std::string ArgumentParser::empty_string = "";
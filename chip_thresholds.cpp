@@ -0,0 +1,131 @@
+#include <cmath>
+#include <sys/stat.h>
+#include <phosphor-logging/elog-errors.hpp>
+#include <xyz/openbmc_project/Control/Device/error.hpp>
+#include "chip_thresholds.hpp"
+#include "sysfs.hpp"
+
+using namespace phosphor::logging;
+
+namespace hwmon
+{
+
+ChipLimits::ChipLimits(std::unique_ptr<hwmonio::HwmonIOInterface> io,
+                       const std::string& devPath,
+                       const SensorSet::key_type& sensor,
+                       const sensor::valueAdjust& adjust,
+                       const char* lo,
+                       const char* hi) :
+    ioAccess(std::move(io)),
+    devPath(devPath),
+    sensor(sensor),
+    gain(adjust.gain),
+    offset(adjust.offset)
+{
+    const char* names[] = {lo, hi};
+    for (size_t i = 0; i < 2; ++i)
+    {
+        if (!names[i])
+        {
+            continue;
+        }
+        limits[i] = names[i];
+
+        // Read-only attributes can be opened for writing by root, only
+        // their mode tells them apart.
+        struct stat st;
+        auto file = sysfs::make_sysfs_path(
+                ioAccess->path(), sensor.first, sensor.second, limits[i]);
+        writable[i] = !stat(file.c_str(), &st) && (st.st_mode & S_IWUSR);
+    }
+}
+
+bool ChipLimits::write(bool high, int64_t value)
+{
+    auto& limit = limits[high];
+    if (limit.empty())
+    {
+        return true;
+    }
+
+    auto file = sysfs::make_sysfs_path(
+            ioAccess->path(), sensor.first, sensor.second, limit);
+    if (!writable[high] || gain == 0)
+    {
+        log<level::ERR>("Chip threshold limit isn't writable",
+                phosphor::logging::entry("FILE=%s", file.c_str()));
+        return false;
+    }
+
+    // Undo the adjustments applied to the value.
+    auto raw = std::llround((value - offset) / gain);
+
+    try
+    {
+        ioAccess->write(
+                raw,
+                sensor.first,
+                sensor.second,
+                limit,
+                hwmonio::retries,
+                hwmonio::delay);
+    }
+    catch (const std::system_error& e)
+    {
+        using namespace sdbusplus::xyz::openbmc_project::Control::
+            Device::Error;
+        report<WriteFailure>(
+                xyz::openbmc_project::Control::Device::
+                    WriteFailure::CALLOUT_ERRNO(e.code().value()),
+                xyz::openbmc_project::Control::Device::
+                    WriteFailure::CALLOUT_DEVICE_PATH(devPath.c_str()));
+
+        log<level::INFO>("Logging failing sysfs file",
+                phosphor::logging::entry("FILE=%s", file.c_str()));
+
+        // The chip keeps its limit, so the threshold does too.
+        return false;
+    }
+
+    return true;
+}
+
+int64_t ChipWarning::warningLow(int64_t value)
+{
+    if (value == WarningObject::warningLow() || !limits.write(false, value))
+    {
+        return WarningObject::warningLow();
+    }
+    return WarningThreshold::warningLow(value);
+}
+
+int64_t ChipWarning::warningHigh(int64_t value)
+{
+    if (value == WarningObject::warningHigh() || !limits.write(true, value))
+    {
+        return WarningObject::warningHigh();
+    }
+    return WarningThreshold::warningHigh(value);
+}
+
+int64_t ChipCritical::criticalLow(int64_t value)
+{
+    if (value == CriticalObject::criticalLow() ||
+        !limits.write(false, value))
+    {
+        return CriticalObject::criticalLow();
+    }
+    return CriticalThreshold::criticalLow(value);
+}
+
+int64_t ChipCritical::criticalHigh(int64_t value)
+{
+    if (value == CriticalObject::criticalHigh() ||
+        !limits.write(true, value))
+    {
+        return CriticalObject::criticalHigh();
+    }
+    return CriticalThreshold::criticalHigh(value);
+}
+
+} // namespace hwmon
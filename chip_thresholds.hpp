@@ -0,0 +1,181 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "hwmonio.hpp"
+#include "interface.hpp"
+#include "sensor.hpp"
+#include "sensorset.hpp"
+#include "threshold_objects.hpp"
+
+namespace hwmon
+{
+
+/**
+ * @class ChipLimits
+ * @brief Writes threshold changes to a chip's limit attributes
+ * @details The low and high thresholds of a kind map to a pair of limit
+ * attributes, like min and max.  Thresholds are converted back to the
+ * chip's units by reversing the sensor's gain and offset.
+ */
+class ChipLimits
+{
+    public:
+        /**
+         * @brief Constructs ChipLimits
+         *
+         * @param[in] io - HwmonIO(instance path) (ex /sys/class/hwmon/hwmon1)
+         * @param[in] devPath - The /sys/devices sysfs path
+         * @param[in] sensor - The sensor's type and id
+         * @param[in] adjust - The sensor's value adjustments
+         * @param[in] lo - The low limit attribute, nullptr if the chip
+         *                 doesn't have it
+         * @param[in] hi - The high limit attribute, nullptr if the chip
+         *                 doesn't have it
+         */
+        ChipLimits(std::unique_ptr<hwmonio::HwmonIOInterface> io,
+                   const std::string& devPath,
+                   const SensorSet::key_type& sensor,
+                   const sensor::valueAdjust& adjust,
+                   const char* lo,
+                   const char* hi);
+
+        /**
+         * @brief Writes a threshold to its limit attribute
+         * @details Thresholds without a limit on the chip aren't written.
+         *
+         * @param[in] high - Whether it's the high threshold
+         * @param[in] value - The threshold, adjusted like the sensor value
+         *
+         * @return false if the chip's limit couldn't be written, and the
+         *         threshold mustn't change
+         */
+        bool write(bool high, int64_t value);
+
+    private:
+        /** @brief Hwmon sysfs access. */
+        std::unique_ptr<hwmonio::HwmonIOInterface> ioAccess;
+        /** @brief Physical device path. */
+        std::string devPath;
+        /** @brief The sensor's type and id. */
+        SensorSet::key_type sensor;
+        /** @brief The sensor's gain. */
+        double gain;
+        /** @brief The sensor's offset. */
+        int offset;
+        /** @brief The low and high limit attributes, empty if missing. */
+        std::string limits[2];
+        /** @brief Whether the low and high limits can be written. */
+        bool writable[2] = {};
+};
+
+/**
+ * @class ChipWarning
+ * @brief Warning thresholds held by the chip
+ * @details Derived WarningThreshold type that writes the thresholds to the
+ * chip's min and max attributes.
+ */
+class ChipWarning : public WarningThreshold
+{
+    public:
+
+        /**
+         * @brief Constructs ChipWarning Object
+         *
+         * @param[in] limits - The chip's min and max attributes
+         * @param[in] lo - initial low threshold
+         * @param[in] hi - initial high threshold
+         * @param[in] bus - Dbus bus object
+         * @param[in] objPath - Dbus object path
+         * @param[in] defer - Dbus object registration defer
+         */
+        ChipWarning(ChipLimits&& limits,
+                    int64_t lo,
+                    int64_t hi,
+                    sdbusplus::bus::bus& bus,
+                    const char* objPath,
+                    bool defer) : WarningThreshold(bus, objPath, defer),
+                        limits(std::move(limits))
+        {
+            WarningObject::warningLow(lo);
+            WarningObject::warningHigh(hi);
+        }
+
+        using WarningThreshold::warningLow;
+        using WarningThreshold::warningHigh;
+
+        /**
+         * @brief Set the value of warningLow
+         *
+         * @return Value of warningLow
+         */
+        int64_t warningLow(int64_t value) override;
+
+        /**
+         * @brief Set the value of warningHigh
+         *
+         * @return Value of warningHigh
+         */
+        int64_t warningHigh(int64_t value) override;
+
+    private:
+        /** @brief The chip's min and max attributes. */
+        ChipLimits limits;
+};
+
+/**
+ * @class ChipCritical
+ * @brief Critical thresholds held by the chip
+ * @details Derived CriticalThreshold type that writes the thresholds to
+ * the chip's lcrit and crit attributes.
+ */
+class ChipCritical : public CriticalThreshold
+{
+    public:
+
+        /**
+         * @brief Constructs ChipCritical Object
+         *
+         * @param[in] limits - The chip's lcrit and crit attributes
+         * @param[in] lo - initial low threshold
+         * @param[in] hi - initial high threshold
+         * @param[in] bus - Dbus bus object
+         * @param[in] objPath - Dbus object path
+         * @param[in] defer - Dbus object registration defer
+         */
+        ChipCritical(ChipLimits&& limits,
+                     int64_t lo,
+                     int64_t hi,
+                     sdbusplus::bus::bus& bus,
+                     const char* objPath,
+                     bool defer) : CriticalThreshold(bus, objPath, defer),
+                        limits(std::move(limits))
+        {
+            CriticalObject::criticalLow(lo);
+            CriticalObject::criticalHigh(hi);
+        }
+
+        using CriticalThreshold::criticalLow;
+        using CriticalThreshold::criticalHigh;
+
+        /**
+         * @brief Set the value of criticalLow
+         *
+         * @return Value of criticalLow
+         */
+        int64_t criticalLow(int64_t value) override;
+
+        /**
+         * @brief Set the value of criticalHigh
+         *
+         * @return Value of criticalHigh
+         */
+        int64_t criticalHigh(int64_t value) override;
+
+    private:
+        /** @brief The chip's lcrit and crit attributes. */
+        ChipLimits limits;
+};
+
+} // namespace hwmon
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace hwmon
+{
+
+/** @class Deadband
+ *  @brief Band around a sensor's last published value.
+ *
+ *  Values within the band of the last published value are not
+ *  worth a PropertiesChanged signal.  The band is either absolute,
+ *  in the units of the adjusted sensor value, or relative to the
+ *  published value, in percent.
+ */
+struct Deadband
+{
+    /** @brief Width of the band either side of the published value. */
+    double band = 0;
+    /** @brief Whether the band is a percentage of the published value. */
+    bool relative = false;
+
+    /** @brief Parse a deadband setting
+     *
+     *  @param[in] setting - "<n>" for absolute or "<n>%" for relative
+     *
+     *  @return The deadband, zero wide if the setting is invalid.
+     */
+    static Deadband parse(const std::string& setting)
+    {
+        Deadband deadband;
+        char* end = nullptr;
+
+        auto band = std::strtod(setting.c_str(), &end);
+        if (end == setting.c_str() || band < 0)
+        {
+            return deadband;
+        }
+
+        deadband.band = band;
+        deadband.relative = (*end == '%');
+        return deadband;
+    }
+
+    /** @brief Check if a value is outside the band
+     *
+     *  @param[in] published - the last published value
+     *  @param[in] value - the new value
+     */
+    bool exceeded(int64_t published, int64_t value) const
+    {
+        auto delta = std::fabs(static_cast<double>(value) - published);
+        auto limit = relative ? std::fabs(published) * band / 100 : band;
+        return delta > limit;
+    }
+
+    bool operator==(const Deadband& other) const
+    {
+        return band == other.band && relative == other.relative;
+    }
+
+    bool operator!=(const Deadband& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+} // namespace hwmon
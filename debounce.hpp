@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+namespace hwmon
+{
+
+/** @class Debounce
+ *  @brief An N-of-M debounce of threshold alarms.
+ *
+ *  An alarm changes once count of the last window samples ask for it.
+ *  The default of one of one changes alarms on every sample.
+ */
+struct Debounce
+{
+    /** @brief Longest window, in samples. */
+    static constexpr uint8_t max_window = 32;
+
+    /** @brief Samples needed to change an alarm. */
+    uint8_t count = 1;
+    /** @brief Samples considered. */
+    uint8_t window = 1;
+
+    /** @brief Parse a debounce setting
+     *
+     *  @param[in] setting - "<n>/<m>" for n of the last m samples, or
+     *                       "<n>" for n in a row
+     *  @param[out] debounce - The debounce, left alone if invalid
+     *
+     *  @return false if the setting is invalid.
+     */
+    static bool parse(const std::string& setting, Debounce& debounce)
+    {
+        char* end = nullptr;
+        auto count = std::strtol(setting.c_str(), &end, 10);
+        if (end == setting.c_str())
+        {
+            return false;
+        }
+
+        auto window = count;
+        if (*end == '/')
+        {
+            auto start = end + 1;
+            window = std::strtol(start, &end, 10);
+            if (end == start)
+            {
+                return false;
+            }
+        }
+
+        if (*end || count < 1 || window < count || window > max_window)
+        {
+            return false;
+        }
+
+        debounce.count = count;
+        debounce.window = window;
+        return true;
+    }
+
+    bool operator==(const Debounce& other) const
+    {
+        return count == other.count && window == other.window;
+    }
+
+    bool operator!=(const Debounce& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+/** @class AlarmFilter
+ *  @brief Hysteresis and debounce of a threshold's low and high alarms.
+ *
+ *  A sample asks for an alarm when it's past the threshold, and keeps
+ *  asking until it's back across the threshold by more than the
+ *  hysteresis.  The alarms then change as the debounce allows.  The
+ *  state is a few words, kept with each polled sensor.
+ */
+struct AlarmFilter
+{
+    /** @brief How far back across a threshold clears its alarm. */
+    int64_t hysteresis = 0;
+    /** @brief The alarms' debounce. */
+    Debounce debounce;
+    /** @brief Whether the low and high alarms are raised. */
+    bool alarmLo = false;
+    bool alarmHi = false;
+    /** @brief Recent samples asking for each alarm, newest in bit 0. */
+    uint32_t samplesLo = 0;
+    uint32_t samplesHi = 0;
+
+    /** @brief Start from the alarms as they are
+     *
+     *  @param[in] lo - Whether the low alarm is raised
+     *  @param[in] hi - Whether the high alarm is raised
+     */
+    void reset(bool lo, bool hi)
+    {
+        alarmLo = lo;
+        alarmHi = hi;
+        samplesLo = lo ? mask() : 0;
+        samplesHi = hi ? mask() : 0;
+    }
+
+    /** @brief Decide one alarm again, for a changed threshold
+     *
+     *  The alarm is set from the reading alone, still allowing the
+     *  hysteresis if it's raised, and its samples restart from that as
+     *  they were taken against the old threshold.  The other alarm and
+     *  its samples are kept.
+     *
+     *  @param[in] value - The sensor reading
+     *  @param[in] threshold - The changed threshold
+     *  @param[in] high - Whether it's the high threshold
+     */
+    void rebase(int64_t value, int64_t threshold, bool high)
+    {
+        if (high)
+        {
+            alarmHi = alarmHi ? value >= threshold - hysteresis :
+                                value >= threshold;
+            samplesHi = alarmHi ? mask() : 0;
+        }
+        else
+        {
+            alarmLo = alarmLo ? value <= threshold + hysteresis :
+                                value <= threshold;
+            samplesLo = alarmLo ? mask() : 0;
+        }
+    }
+
+    /** @brief Take a sample
+     *
+     *  @param[in] value - The sensor reading
+     *  @param[in] lo - The low threshold
+     *  @param[in] hi - The high threshold
+     *
+     *  @return Whether the low and high alarms are raised.
+     */
+    std::pair<bool, bool> sample(int64_t value, int64_t lo, int64_t hi)
+    {
+        auto pastLo = alarmLo ? value <= lo + hysteresis : value <= lo;
+        auto pastHi = alarmHi ? value >= hi - hysteresis : value >= hi;
+        alarmLo = update(alarmLo, pastLo, samplesLo);
+        alarmHi = update(alarmHi, pastHi, samplesHi);
+        return alarms();
+    }
+
+    /** @brief Whether the low and high alarms are raised. */
+    std::pair<bool, bool> alarms() const
+    {
+        return std::make_pair(alarmLo, alarmHi);
+    }
+
+    /** @brief The samples in the debounce window. */
+    uint32_t mask() const
+    {
+        return (debounce.window < Debounce::max_window) ?
+            (1u << debounce.window) - 1 : ~0u;
+    }
+
+    /** @brief Add a sample to an alarm's samples and debounce it. */
+    bool update(bool alarm, bool past, uint32_t& samples) const
+    {
+        samples = ((samples << 1) | past) & mask();
+        auto asking = __builtin_popcount(samples);
+        return alarm ? (debounce.window - asking < debounce.count) :
+                       (asking >= debounce.count);
+    }
+};
+
+} // namespace hwmon
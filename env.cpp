@@ -15,15 +15,105 @@
  */
 
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <unistd.h>
 
 #include "env.hpp"
 #include "hwmon.hpp"
 
 namespace env {
 
+/** @brief Settings overlaid by the innermost Scope. */
+static const Settings* current = nullptr;
+
+Scope::Scope(const Settings* settings) : previous(current)
+{
+    if (settings)
+    {
+        current = settings;
+    }
+}
+
+Scope::~Scope()
+{
+    current = previous;
+}
+
+Settings loadSettings(const std::string& path)
+{
+    Settings settings;
+    std::ifstream handle(path.c_str());
+    std::string line;
+
+    while (std::getline(handle, line))
+    {
+        auto begin = line.find_first_not_of(" \t");
+        if (begin == std::string::npos || line[begin] == '#')
+        {
+            continue;
+        }
+
+        auto equals = line.find('=', begin);
+        if (equals == std::string::npos)
+        {
+            continue;
+        }
+
+        auto key = line.substr(begin, equals - begin);
+        key.erase(key.find_last_not_of(" \t") + 1);
+
+        auto value = line.substr(equals + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t\r") + 1);
+        if (value.size() >= 2 &&
+            (value.front() == '"' || value.front() == '\'') &&
+            value.back() == value.front())
+        {
+            value = value.substr(1, value.size() - 2);
+        }
+
+        settings[std::move(key)] = std::move(value);
+    }
+
+    return settings;
+}
+
+Settings getAll()
+{
+    Settings settings;
+
+    for (auto var = environ; var && *var; ++var)
+    {
+        auto equals = std::strchr(*var, '=');
+        if (equals)
+        {
+            settings.emplace(std::string(*var, equals), equals + 1);
+        }
+    }
+
+    if (current)
+    {
+        for (const auto& setting : *current)
+        {
+            settings[setting.first] = setting.second;
+        }
+    }
+
+    return settings;
+}
+
 std::string getEnv(const char* key)
 {
+    if (current)
+    {
+        auto setting = current->find(key);
+        if (setting != current->end())
+        {
+            return setting->second;
+        }
+    }
+
     auto value = std::getenv(key);
     return (value) ? std::string(value) : std::string();
 }
@@ -1,11 +1,66 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 
 #include "sensorset.hpp"
 
 namespace env {
 
+/** @brief Environment settings of a single device. */
+using Settings = std::unordered_map<std::string, std::string>;
+
+/** @class Scope
+ *  @brief Overlays a device's settings on the environment.
+ *
+ *  While a scope is alive, getEnv() looks keys up in its settings
+ *  before the process environment.  This lets several devices with
+ *  their own settings share a process.  Scopes nest, and a scope
+ *  without settings leaves the process environment visible.
+ */
+class Scope
+{
+    public:
+        Scope() = delete;
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        Scope(Scope&&) = delete;
+        Scope& operator=(Scope&&) = delete;
+
+        /** @brief Overlay settings until the scope is destroyed
+         *
+         *  @param[in] settings - the settings, or nullptr for none
+         */
+        explicit Scope(const Settings* settings);
+
+        ~Scope();
+
+    private:
+        /** @brief The settings overlaid before this scope. */
+        const Settings* previous;
+};
+
+/** @brief Loads device settings from an environment file
+ *
+ *  Reads KEY=VALUE lines, as found in the files given to systemd's
+ *  EnvironmentFile=.  Blank lines and lines starting with # are
+ *  skipped and values may be quoted.
+ *
+ *  @param[in] path - the file to load
+ *
+ *  @return Settings - the settings, empty if the file can't be read
+ */
+Settings loadSettings(const std::string& path);
+
+/** @brief Reads the whole environment
+ *
+ *  Reads the process environment, with the settings of the
+ *  innermost scope overlaid on it.
+ *
+ *  @return Settings - every variable and its value
+ */
+Settings getAll();
+
 /** @brief Reads an environment variable
  *
  *  Reads the environment for that key
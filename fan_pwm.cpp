@@ -34,6 +34,12 @@ uint64_t FanPwm::target(uint64_t value)
     }
     catch (const std::system_error& e)
     {
+        if (hwmonio::isGone(e.code().value()))
+        {
+            // The device went away, the poll loop stops monitoring it.
+            return FanPwmObject::target();
+        }
+
         using namespace sdbusplus::xyz::openbmc_project::Control::
             Device::Error;
         report<WriteFailure>(
@@ -51,7 +57,8 @@ uint64_t FanPwm::target(uint64_t value)
         log<level::INFO>("Logging failing sysfs file",
                          phosphor::logging::entry("FILE=%s", file.c_str()));
 
-        exit(EXIT_FAILURE);
+        failed();
+        return FanPwmObject::target();
     }
 
     return FanPwmObject::target(value);
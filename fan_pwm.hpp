@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 
 #include "hwmonio.hpp"
@@ -28,6 +29,9 @@ class FanPwm : public FanPwmObject
          * @param[in] bus - Dbus bus object
          * @param[in] objPath - Dbus object path
          * @param[in] defer - Dbus object registration defer
+         * @param[in] target - initial target pwm value
+         * @param[in] failed - called when a write fails, to stop
+         *                     monitoring the device
          */
     FanPwm(std::unique_ptr<hwmonio::HwmonIOInterface> io,
            const std::string& devPath,
@@ -35,10 +39,12 @@ class FanPwm : public FanPwmObject
            sdbusplus::bus::bus& bus,
            const char* objPath,
            bool defer,
-           uint64_t target) : FanPwmObject(bus, objPath, defer),
+           uint64_t target,
+           std::function<void()> failed) : FanPwmObject(bus, objPath, defer),
                 id(id),
                 ioAccess(std::move(io)),
-                devPath(devPath)
+                devPath(devPath),
+                failed(std::move(failed))
         {
             FanPwmObject::target(target);
         }
@@ -59,6 +65,8 @@ class FanPwm : public FanPwmObject
         std::unique_ptr<hwmonio::HwmonIOInterface> ioAccess;
         /** @brief Physical device path. */
         std::string devPath;
+        /** @brief Called when a write fails. */
+        std::function<void()> failed;
 };
 
 } // namespace hwmon
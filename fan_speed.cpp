@@ -1,7 +1,6 @@
 #include <phosphor-logging/elog-errors.hpp>
 #include <xyz/openbmc_project/Control/Device/error.hpp>
 #include "sensorset.hpp"
-#include "env.hpp"
 #include "fan_speed.hpp"
 #include "hwmon.hpp"
 #include "hwmonio.hpp"
@@ -32,6 +31,12 @@ uint64_t FanSpeed::target(uint64_t value)
         }
         catch (const std::system_error& e)
         {
+            if (hwmonio::isGone(e.code().value()))
+            {
+                // The device went away, the poll loop stops monitoring it.
+                return curValue;
+            }
+
             using namespace sdbusplus::xyz::openbmc_project::Control::
                 Device::Error;
             report<WriteFailure>(
@@ -49,7 +54,8 @@ uint64_t FanSpeed::target(uint64_t value)
             log<level::INFO>("Logging failing sysfs file",
                     phosphor::logging::entry("FILE=%s", file.c_str()));
 
-            exit(EXIT_FAILURE);
+            failed();
+            return curValue;
         }
     }
 
@@ -57,44 +63,44 @@ uint64_t FanSpeed::target(uint64_t value)
 }
 
 
-void FanSpeed::enable()
+void FanSpeed::enable(unsigned long value)
 {
-    auto enable = env::getEnv("ENABLE", type, id);
-    if (!enable.empty())
+    try
     {
-        auto val = std::stoul(enable);
-
-        try
+        ioAccess->write(
+                value,
+                type::pwm,
+                id,
+                entry::enable,
+                hwmonio::retries,
+                hwmonio::delay);
+    }
+    catch (const std::system_error& e)
+    {
+        if (hwmonio::isGone(e.code().value()))
         {
-            ioAccess->write(
-                    val,
-                    type::pwm,
-                    id,
-                    entry::enable,
-                    hwmonio::retries,
-                    hwmonio::delay);
+            // The device went away, the poll loop stops monitoring it.
+            return;
         }
-        catch (const std::system_error& e)
-        {
-            using namespace sdbusplus::xyz::openbmc_project::Control::
-                Device::Error;
-            phosphor::logging::report<WriteFailure>(
-                    xyz::openbmc_project::Control::Device::
-                        WriteFailure::CALLOUT_ERRNO(e.code().value()),
-                    xyz::openbmc_project::Control::Device::
-                        WriteFailure::CALLOUT_DEVICE_PATH(devPath.c_str()));
 
-            auto fullPath = sysfs::make_sysfs_path(
-                    ioAccess->path(),
-                    type::pwm,
-                    id,
-                    entry::enable);
+        using namespace sdbusplus::xyz::openbmc_project::Control::
+            Device::Error;
+        phosphor::logging::report<WriteFailure>(
+                xyz::openbmc_project::Control::Device::
+                    WriteFailure::CALLOUT_ERRNO(e.code().value()),
+                xyz::openbmc_project::Control::Device::
+                    WriteFailure::CALLOUT_DEVICE_PATH(devPath.c_str()));
 
-            log<level::INFO>("Logging failing sysfs file",
-                    phosphor::logging::entry("FILE=%s", fullPath.c_str()));
+        auto fullPath = sysfs::make_sysfs_path(
+                ioAccess->path(),
+                type::pwm,
+                id,
+                entry::enable);
 
-            exit(EXIT_FAILURE);
-        }
+        log<level::INFO>("Logging failing sysfs file",
+                phosphor::logging::entry("FILE=%s", fullPath.c_str()));
+
+        failed();
     }
 }
 
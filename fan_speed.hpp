@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 
 #include "hwmonio.hpp"
@@ -29,6 +30,8 @@ class FanSpeed : public FanSpeedObject
          * @param[in] objPath - Dbus object path
          * @param[in] defer - Dbus object registration defer
          * @param[in] target - initial target speed value
+         * @param[in] failed - called when a write fails, to stop
+         *                     monitoring the device
          */
         FanSpeed(std::unique_ptr<hwmonio::HwmonIOInterface> io,
                  const std::string& devPath,
@@ -36,10 +39,13 @@ class FanSpeed : public FanSpeedObject
                  sdbusplus::bus::bus& bus,
                  const char* objPath,
                  bool defer,
-                 uint64_t target) : FanSpeedObject(bus, objPath, defer),
+                 uint64_t target,
+                 std::function<void()> failed) :
+                    FanSpeedObject(bus, objPath, defer),
                     id(id),
                     ioAccess(std::move(io)),
-                    devPath(devPath)
+                    devPath(devPath),
+                    failed(std::move(failed))
         {
             FanSpeedObject::target(target);
         }
@@ -52,10 +58,11 @@ class FanSpeed : public FanSpeedObject
         uint64_t target(uint64_t value) override;
 
         /**
-         * @brief Writes the pwm_enable sysfs entry if the
-         *        env var with the value to write is present
+         * @brief Writes the pwm_enable sysfs entry
+         *
+         * @param[in] value - The value to write
          */
-        void enable();
+        void enable(unsigned long value);
 
     private:
         /** @brief hwmon type */
@@ -66,6 +73,8 @@ class FanSpeed : public FanSpeedObject
         std::unique_ptr<hwmonio::HwmonIOInterface> ioAccess;
         /** @brief Physical device path. */
         std::string devPath;
+        /** @brief Called when a write fails. */
+        std::function<void()> failed;
 
 };
 
@@ -0,0 +1,135 @@
+/**
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cmath>
+
+#include "history.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+History::History(size_t capacity, const std::vector<size_t>& windows) :
+    samples(std::max<size_t>(capacity, 1))
+{
+    auto lengths = windows;
+    if (lengths.empty())
+    {
+        lengths.push_back(samples.size());
+    }
+
+    for (auto length : lengths)
+    {
+        Window w;
+        w.length = std::min(std::max<size_t>(length, 1), samples.size());
+        w.min.seqs.resize(w.length);
+        w.max.seqs.resize(w.length);
+        stats.push_back(std::move(w));
+    }
+}
+
+bool History::add(uint64_t time, int64_t value)
+{
+    auto seq = added;
+
+    for (auto& w : stats)
+    {
+        if (seq == 0)
+        {
+            w.shift = value;
+        }
+
+        // The reading leaving the window may be the one replaced in
+        // the ring, so it's taken out of the sums first.
+        if (seq >= w.length)
+        {
+            double old = this->value(seq - w.length) - w.shift;
+            w.sum -= old;
+            w.squares -= old * old;
+        }
+        double v = value - w.shift;
+        w.sum += v;
+        w.squares += v * v;
+
+        while (w.min.count && w.min.front() + w.length <= seq)
+        {
+            w.min.popFront();
+        }
+        while (w.min.count && this->value(w.min.back()) >= value)
+        {
+            w.min.popBack();
+        }
+        w.min.pushBack(seq);
+
+        while (w.max.count && w.max.front() + w.length <= seq)
+        {
+            w.max.popFront();
+        }
+        while (w.max.count && this->value(w.max.back()) <= value)
+        {
+            w.max.popBack();
+        }
+        w.max.pushBack(seq);
+    }
+
+    samples[seq % samples.size()] = Sample{time, value};
+    added = seq + 1;
+
+    auto completed = false;
+    for (auto& w : stats)
+    {
+        if (added % w.length)
+        {
+            continue;
+        }
+        completed = true;
+
+        // Recompute the sums once per window length, around the latest
+        // reading, so rounding errors don't accumulate.
+        w.shift = value;
+        w.sum = 0;
+        w.squares = 0;
+        for (auto s = added - w.length; s < added; ++s)
+        {
+            double v = this->value(s) - w.shift;
+            w.sum += v;
+            w.squares += v * v;
+        }
+    }
+
+    return completed;
+}
+
+History::Statistics History::statistics(size_t n) const
+{
+    const auto& w = stats[n];
+
+    Statistics s{w.length, std::min<size_t>(added, w.length), 0, 0, 0, 0};
+    if (!s.count)
+    {
+        return s;
+    }
+
+    s.min = value(w.min.front());
+    s.max = value(w.max.front());
+
+    auto mean = w.sum / s.count;
+    s.mean = w.shift + mean;
+    s.stddev = std::sqrt(std::max(w.squares / s.count - mean * mean, 0.0));
+
+    return s;
+}
+
+} // namespace hwmon
+} // namespace phosphor
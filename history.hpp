@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+/** @class History
+ *  @brief Fixed-size ring of a sensor's readings, with statistics
+ *         over windows of the latest of them.
+ *
+ *  All storage is allocated up front.  The sums behind the mean and
+ *  standard deviation are kept incrementally and recomputed from the
+ *  ring once per window length so rounding can't build up, and the
+ *  minimum and maximum come from monotonic queues, so adding a
+ *  reading costs amortized constant time per window.
+ */
+class History
+{
+    public:
+        /** @brief Most readings a history can keep. */
+        static constexpr size_t max_capacity = 65536;
+
+        History() = delete;
+        History(const History&) = delete;
+        History& operator=(const History&) = delete;
+        History(History&&) = default;
+        History& operator=(History&&) = default;
+        ~History() = default;
+
+        /** @brief A reading. */
+        struct Sample
+        {
+            /** @brief CLOCK_MONOTONIC time, in microseconds. */
+            uint64_t time;
+            int64_t value;
+        };
+
+        /** @brief Statistics of a window. */
+        struct Statistics
+        {
+            /** @brief Window length, in samples. */
+            size_t window;
+            /** @brief Samples in the window, fewer until it fills. */
+            size_t count;
+            int64_t min;
+            int64_t max;
+            double mean;
+            double stddev;
+        };
+
+        /** @brief Constructs the history
+         *
+         *  @param[in] capacity - readings kept, at least one
+         *  @param[in] windows - window lengths in samples, clamped to
+         *                       the capacity, the whole history if none
+         */
+        History(size_t capacity, const std::vector<size_t>& windows);
+
+        /** @brief Add a reading, replacing the oldest once full
+         *
+         *  @param[in] time - when it was read
+         *  @param[in] value - the adjusted value
+         *
+         *  @return Whether it completed a window of any length, so its
+         *          sums were recomputed.
+         */
+        bool add(uint64_t time, int64_t value);
+
+        /** @brief Readings kept, at most the capacity. */
+        size_t size() const
+        {
+            return std::min<uint64_t>(added, samples.size());
+        }
+
+        /** @brief Readings that can be kept. */
+        size_t capacity() const
+        {
+            return samples.size();
+        }
+
+        /** @brief Get a kept reading
+         *
+         *  @param[in] n - index from the oldest kept, below size()
+         */
+        const Sample& operator[](size_t n) const
+        {
+            return samples[(added - size() + n) % samples.size()];
+        }
+
+        /** @brief Number of statistics windows. */
+        size_t windows() const
+        {
+            return stats.size();
+        }
+
+        /** @brief Get the statistics of a window
+         *
+         *  @param[in] n - index of the window, in the constructor's order
+         */
+        Statistics statistics(size_t n) const;
+
+    private:
+        /** @brief Fixed-size double ended queue of sequence numbers. */
+        struct Queue
+        {
+            std::vector<uint64_t> seqs;
+            size_t head = 0;
+            size_t count = 0;
+
+            uint64_t front() const
+            {
+                return seqs[head];
+            }
+            uint64_t back() const
+            {
+                return seqs[(head + count - 1) % seqs.size()];
+            }
+            void popFront()
+            {
+                head = (head + 1) % seqs.size();
+                --count;
+            }
+            void popBack()
+            {
+                --count;
+            }
+            void pushBack(uint64_t seq)
+            {
+                seqs[(head + count) % seqs.size()] = seq;
+                ++count;
+            }
+        };
+
+        /** @brief Running statistics of a window. */
+        struct Window
+        {
+            size_t length;
+            /** @brief Taken off the values in the sums, to keep the
+             *         squares small. */
+            int64_t shift = 0;
+            double sum = 0;
+            double squares = 0;
+            /** @brief Sequence numbers of the candidate minimums,
+             *         increasing in value. */
+            Queue min;
+            /** @brief Sequence numbers of the candidate maximums,
+             *         decreasing in value. */
+            Queue max;
+        };
+
+        /** @brief The value with a sequence number, still in the ring. */
+        int64_t value(uint64_t seq) const
+        {
+            return samples[seq % samples.size()].value;
+        }
+
+        /** @brief The ring of readings, by sequence number. */
+        std::vector<Sample> samples;
+        /** @brief Readings added, the sequence number of the next. */
+        uint64_t added = 0;
+        std::vector<Window> stats;
+};
+
+} // namespace hwmon
+} // namespace phosphor
@@ -0,0 +1,191 @@
+/**
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cerrno>
+#include <experimental/filesystem>
+#include <linux/netlink.h>
+#include <phosphor-logging/log.hpp>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "hotplug.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+using namespace phosphor::logging;
+
+/** @brief Netlink group the kernel sends uevents to. */
+static constexpr auto kernelUevents = 1;
+
+HotPlug::HotPlug(sd_event* event,
+                 const std::string& path,
+                 std::function<void()> callback) :
+    event(event),
+    callback(callback)
+{
+    watchDirectory(path);
+    watchUevents(path);
+}
+
+HotPlug::~HotPlug()
+{
+    if (inotifySource)
+    {
+        inotifySource = sd_event_source_unref(inotifySource);
+    }
+    if (ueventSource)
+    {
+        ueventSource = sd_event_source_unref(ueventSource);
+    }
+}
+
+void HotPlug::watchDirectory(const std::string& path)
+{
+    inotifyFd = hwmonio::FileDescriptor(
+            inotify_init1(IN_NONBLOCK | IN_CLOEXEC));
+    if (!inotifyFd ||
+        inotify_add_watch(inotifyFd(), path.c_str(),
+                          IN_CREATE | IN_DELETE |
+                          IN_MOVED_FROM | IN_MOVED_TO) < 0)
+    {
+        log<level::INFO>("Unable to watch hwmon directory",
+                         entry("PATH=%s", path.c_str()),
+                         entry("ERROR=%s", strerror(errno)));
+        inotifyFd = hwmonio::FileDescriptor();
+        return;
+    }
+
+    auto r = sd_event_add_io(event, &inotifySource, inotifyFd(), EPOLLIN,
+                             inotifyHandler, this);
+    if (r < 0)
+    {
+        throw std::system_error(-r, std::generic_category(), strerror(-r));
+    }
+}
+
+void HotPlug::watchUevents(const std::string& path)
+{
+    namespace fs = std::experimental::filesystem;
+
+    // uevents name devices by their canonical path under /sys.
+    std::error_code ec;
+    devPath = fs::canonical(path, ec).string();
+    if (ec || devPath.compare(0, 4, "/sys") != 0)
+    {
+        devPath.clear();
+        return;
+    }
+    devPath.erase(0, 4);
+
+    ueventFd = hwmonio::FileDescriptor(
+            socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                   NETLINK_KOBJECT_UEVENT));
+
+    sockaddr_nl addr{};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = kernelUevents;
+
+    if (!ueventFd ||
+        bind(ueventFd(), reinterpret_cast<sockaddr*>(&addr),
+             sizeof(addr)) < 0)
+    {
+        log<level::INFO>("Unable to listen for uevents",
+                         entry("ERROR=%s", strerror(errno)));
+        ueventFd = hwmonio::FileDescriptor();
+        return;
+    }
+
+    auto r = sd_event_add_io(event, &ueventSource, ueventFd(), EPOLLIN,
+                             ueventHandler, this);
+    if (r < 0)
+    {
+        throw std::system_error(-r, std::generic_category(), strerror(-r));
+    }
+}
+
+void HotPlug::schedule()
+{
+    if (!settle)
+    {
+        settle = std::make_unique<Timer>(
+                event, callback, settleTime, timer::ONESHOT);
+    }
+    else
+    {
+        settle->start(settleTime, timer::ONESHOT);
+    }
+}
+
+bool HotPlug::related(const std::string& path) const
+{
+    // Either path may be the leading part of the other.
+    auto n = std::min(path.size(), devPath.size());
+    if (path.compare(0, n, devPath, 0, n) != 0)
+    {
+        return false;
+    }
+
+    return path.size() == devPath.size() ||
+           (path.size() > n ? path[n] : devPath[n]) == '/';
+}
+
+int HotPlug::inotifyHandler(sd_event_source* eventSource,
+                            int fd, uint32_t revents, void* userData)
+{
+    auto hotplug = static_cast<HotPlug*>(userData);
+    alignas(inotify_event) char buf[4096];
+
+    // Any change to the directory calls for a rescan, so there's no
+    // need to look at the events themselves.
+    while (::read(fd, buf, sizeof(buf)) > 0)
+    {
+    }
+
+    hotplug->schedule();
+    return 0;
+}
+
+int HotPlug::ueventHandler(sd_event_source* eventSource,
+                           int fd, uint32_t revents, void* userData)
+{
+    auto hotplug = static_cast<HotPlug*>(userData);
+    char buf[8192];
+    auto matched = false;
+
+    ssize_t size;
+    while ((size = recv(fd, buf, sizeof(buf) - 1, 0)) > 0)
+    {
+        // The message starts with "<action>@<devpath>".
+        buf[size] = '\0';
+        auto at = strchr(buf, '@');
+        if (at && hotplug->related(at + 1))
+        {
+            matched = true;
+        }
+    }
+
+    if (matched)
+    {
+        hotplug->schedule();
+    }
+    return 0;
+}
+
+} // namespace hwmon
+} // namespace phosphor
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <systemd/sd-event.h>
+
+#include "hwmonio.hpp"
+#include "timer.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+/** @brief Time to let a burst of hot-plug events settle. */
+static constexpr auto settleTime = std::chrono::milliseconds(100);
+
+/** @class HotPlug
+ *  @brief Watches a hwmon instance for sensors coming and going.
+ *
+ *  Changes are picked up from inotify events on the instance
+ *  directory and from kernel uevents for the instance's device, the
+ *  devices above it or the devices below it.  A burst of events
+ *  results in a single callback once the events have settled.
+ */
+class HotPlug
+{
+    public:
+        HotPlug() = delete;
+        HotPlug(const HotPlug&) = delete;
+        HotPlug& operator=(const HotPlug&) = delete;
+        HotPlug(HotPlug&&) = delete;
+        HotPlug& operator=(HotPlug&&) = delete;
+        ~HotPlug();
+
+        /** @brief Constructs the watch
+         *
+         *  Watches that can't be set up are logged and skipped.
+         *
+         *  @param[in] event - sd_event loop to watch in
+         *  @param[in] path - hwmon sysfs instance to watch
+         *  @param[in] callback - called when the instance changed
+         */
+        HotPlug(sd_event* event,
+                const std::string& path,
+                std::function<void()> callback);
+
+        /** @brief Call the callback after the settle time, again if
+         *         it was already called.
+         */
+        void schedule();
+
+    private:
+        /** @brief inotify event handler */
+        static int inotifyHandler(sd_event_source* eventSource,
+                                  int fd, uint32_t revents, void* userData);
+
+        /** @brief uevent netlink socket handler */
+        static int ueventHandler(sd_event_source* eventSource,
+                                 int fd, uint32_t revents, void* userData);
+
+        /** @brief Watch the instance directory with inotify. */
+        void watchDirectory(const std::string& path);
+
+        /** @brief Listen for the instance's device uevents. */
+        void watchUevents(const std::string& path);
+
+        /** @brief Check if a uevent's device is related to the instance
+         *
+         *  @param[in] devPath - the uevent DEVPATH, relative to /sys
+         */
+        bool related(const std::string& devPath) const;
+
+        /** @brief the sd_event structure */
+        sd_event* event;
+
+        /** @brief Called once events have settled */
+        std::function<void()> callback;
+
+        /** @brief The instance's device path, relative to /sys */
+        std::string devPath;
+
+        hwmonio::FileDescriptor inotifyFd;
+        hwmonio::FileDescriptor ueventFd;
+        sd_event_source* inotifySource = nullptr;
+        sd_event_source* ueventSource = nullptr;
+
+        /** @brief Settle timer, created when first needed */
+        std::unique_ptr<Timer> settle;
+};
+
+} // namespace hwmon
+} // namespace phosphor
@@ -14,6 +14,10 @@ static constexpr auto clabel = "label";
 static constexpr auto ctarget = "target";
 static constexpr auto cenable = "enable";
 static constexpr auto cfault = "fault";
+static constexpr auto cminalarm = "min_alarm";
+static constexpr auto cmaxalarm = "max_alarm";
+static constexpr auto clcritalarm = "lcrit_alarm";
+static constexpr auto ccritalarm = "crit_alarm";
 
 static const std::string input = cinput;
 static const std::string label = clabel;
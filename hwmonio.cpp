@@ -12,9 +12,14 @@
  * limitations under the License.
  */
 #include <algorithm>
-#include <exception>
-#include <fstream>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <system_error>
 #include <thread>
+#include <unistd.h>
 
 #include "config.h"
 #include "hwmonio.hpp"
@@ -68,88 +73,238 @@ static constexpr auto retryableErrors = {
     EMSGSIZE,
 };
 
+bool isRetryable(int rc)
+{
+    return 0 != std::count(
+            retryableErrors.begin(),
+            retryableErrors.end(),
+            rc);
+}
+
+bool isGone(int rc)
+{
+    return rc == ENOENT || rc == ENODEV;
+}
+
+FileDescriptor& FileDescriptor::operator=(FileDescriptor&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+        fd = other.fd;
+        other.fd = -1;
+    }
+
+    return *this;
+}
+
+FileDescriptor::~FileDescriptor()
+{
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+}
+
+constexpr size_t HwmonIO::bufSize;
+
+bool HwmonIO::isStale(int rc)
+{
+    // The descriptor no longer refers to the attribute, for
+    // example after a driver rebind.
+    return rc == ENODEV || rc == ENOENT || rc == EBADF;
+}
+
+int HwmonIO::parse(char* buf, size_t len, int64_t& val)
+{
+    buf[len] = '\0';
+    char* end = nullptr;
+    errno = 0;
+    val = std::strtoll(buf, &end, 10);
+    if (end == buf || errno)
+    {
+        return errno ? errno : EINVAL;
+    }
+
+    return 0;
+}
+
 HwmonIO::HwmonIO(const std::string& path) : p(path)
 {
 }
 
-int64_t HwmonIO::read(
+int HwmonIO::open(Cache& cache, const std::string& path, int flags)
+{
+    auto it = cache.find(path);
+    if (it != cache.end())
+    {
+        return it->second();
+    }
+
+    FileDescriptor fd{::open(path.c_str(), flags | O_CLOEXEC)};
+    if (!fd)
+    {
+        return -1;
+    }
+
+    auto raw = fd();
+    cache.emplace(path, std::move(fd));
+    return raw;
+}
+
+HwmonIO::Attribute HwmonIO::attribute(const std::string& path) const
+{
+    auto it = handles.find(path);
+    if (it != handles.end())
+    {
+        return it->second;
+    }
+
+    auto handle = slots.size();
+    slots.push_back(Slot{path, FileDescriptor()});
+    handles.emplace(path, handle);
+    return handle;
+}
+
+HwmonIO::Attribute HwmonIO::attribute(
         const std::string& type,
         const std::string& id,
-        const std::string& sensor,
-        size_t retries,
-        std::chrono::milliseconds delay) const
+        const std::string& sensor) const
 {
-    int64_t val;
-    std::ifstream ifs;
-    auto fullPath = sysfs::make_sysfs_path(
-            p, type, id, sensor);
+    return attribute(sysfs::make_sysfs_path(p, type, id, sensor));
+}
+
+int HwmonIO::open(Attribute attribute) const
+{
+    auto& slot = slots[attribute];
+    if (!slot.fd)
+    {
+        slot.fd = FileDescriptor{
+                ::open(slot.path.c_str(), O_RDONLY | O_CLOEXEC)};
+    }
 
-    ifs.exceptions(
-            std::ifstream::failbit |
-                std::ifstream::badbit |
-                std::ifstream::eofbit);
+    return slot.fd();
+}
+
+void HwmonIO::close(Attribute attribute) const
+{
+    slots[attribute].fd = FileDescriptor();
+}
+
+int HwmonIO::readOnce(Attribute attribute, int64_t& val) const
+{
+    char buf[bufSize];
+    auto reopened = false;
 
     while (true)
     {
-        try
-        {
-            errno = 0;
-            if (!ifs.is_open())
-                ifs.open(fullPath);
-            ifs.clear();
-            ifs.seekg(0);
-            ifs >> val;
-        }
-        catch (const std::exception& e)
+        auto fd = open(attribute);
+        auto n = (fd < 0) ? -1 : ::pread(fd, buf, sizeof(buf) - 1, 0);
+        if (n < 0)
         {
             auto rc = errno;
-
-            if (!rc)
+            if (fd >= 0 && isStale(rc) && !reopened)
             {
-                throw;
+                close(attribute);
+                reopened = true;
+                continue;
             }
 
-            if (rc == ENOENT || rc == ENODEV)
+            return rc;
+        }
+
+        return parse(buf, n, val);
+    }
+}
+
+int HwmonIO::writeOnce(const std::string& path, int64_t val) const
+{
+    char buf[24];
+    auto len = std::snprintf(buf, sizeof(buf), "%" PRId64, val);
+    auto reopened = false;
+
+    while (true)
+    {
+        auto fd = open(writeFds, path, O_WRONLY);
+        auto n = (fd < 0) ? -1 : ::pwrite(fd, buf, len, 0);
+        if (n < 0)
+        {
+            auto rc = errno;
+            if (fd >= 0 && isStale(rc) && !reopened)
             {
-                // If the directory or device disappeared then this application
-                // should gracefully exit.  There are race conditions between the
-                // unloading of a hwmon driver and the stopping of this service
-                // by systemd.  To prevent this application from falsely failing
-                // in these scenarios, it will simply exit if the directory or
-                // file can not be found.  It is up to the user(s) of this
-                // provided hwmon object to log the appropriate errors if the
-                // object disappears when it should not.
-                exit(0);
+                writeFds.erase(path);
+                reopened = true;
+                continue;
             }
 
-            if (0 == std::count(
-                        retryableErrors.begin(),
-                        retryableErrors.end(),
-                        rc) ||
-                    !retries)
-            {
-                // Not a retryable error or out of retries.
+            return rc;
+        }
+
+        return 0;
+    }
+}
+
+int HwmonIO::tryRead(Attribute attr, int64_t& val) const
+{
+    return readOnce(attr, val);
+}
+
+int64_t HwmonIO::read(
+        const std::string& type,
+        const std::string& id,
+        const std::string& sensor,
+        size_t retries,
+        std::chrono::milliseconds delay) const
+{
+    int64_t val;
+    auto handle = attribute(type, id, sensor);
+
+    while (true)
+    {
+        auto rc = readOnce(handle, val);
+        if (!rc)
+        {
+            break;
+        }
+
+        if (isGone(rc))
+        {
+            // If the directory or device disappeared then the caller
+            // should gracefully stop monitoring it.  There are race
+            // conditions between the unloading of a hwmon driver and the
+            // stopping of this service by systemd.  To prevent this
+            // application from falsely failing in these scenarios, the
+            // caller checks for this with isGone().  It is up to the
+            // user(s) of this provided hwmon object to log the
+            // appropriate errors if the object disappears when it
+            // should not.
+            throw std::system_error(rc, std::generic_category());
+        }
+
+        if (!isRetryable(rc) || !retries)
+        {
+            // Not a retryable error or out of retries.
 #ifdef NEGATIVE_ERRNO_ON_FAIL
-                return -rc;
+            return -rc;
 #endif
 
-                // Work around GCC bugs 53984 and 66145 for callers by
-                // explicitly raising system_error here.
-                throw std::system_error(rc, std::generic_category());
-            }
-
-            --retries;
-            std::this_thread::sleep_for(delay);
-            continue;
+            // Work around GCC bugs 53984 and 66145 for callers by
+            // explicitly raising system_error here.
+            throw std::system_error(rc, std::generic_category());
         }
-        break;
+
+        --retries;
+        std::this_thread::sleep_for(delay);
     }
 
     return val;
 }
 
 void HwmonIO::write(
-        uint32_t val,
+        int64_t val,
         const std::string& type,
         const std::string& id,
         const std::string& sensor,
@@ -157,62 +312,36 @@ void HwmonIO::write(
         std::chrono::milliseconds delay) const
 
 {
-    std::ofstream ofs;
     auto fullPath = sysfs::make_sysfs_path(
             p, type, id, sensor);
 
-    ofs.exceptions(
-            std::ofstream::failbit |
-                std::ofstream::badbit |
-                std::ofstream::eofbit);
-
     // See comments in the read method for an explanation of the odd exception
     // handling behavior here.
 
     while (true)
     {
-        try
+        auto rc = writeOnce(fullPath, val);
+        if (!rc)
         {
-            errno = 0;
-            if (!ofs.is_open())
-                ofs.open(fullPath);
-            ofs.clear();
-            ofs.seekp(0);
-            ofs << val;
-            ofs.flush();
+            break;
         }
-        catch (const std::exception& e)
-        {
-            auto rc = errno;
-
-            if (!rc)
-            {
-                throw;
-            }
 
-            if (rc == ENOENT)
-            {
-                exit(0);
-            }
-
-            if (0 == std::count(
-                        retryableErrors.begin(),
-                        retryableErrors.end(),
-                        rc) ||
-                    !retries)
-            {
-                // Not a retryable error or out of retries.
+        if (rc == ENOENT)
+        {
+            throw std::system_error(rc, std::generic_category());
+        }
 
-                // Work around GCC bugs 53984 and 66145 for callers by
-                // explicitly raising system_error here.
-                throw std::system_error(rc, std::generic_category());
-            }
+        if (!isRetryable(rc) || !retries)
+        {
+            // Not a retryable error or out of retries.
 
-            --retries;
-            std::this_thread::sleep_for(delay);
-            continue;
+            // Work around GCC bugs 53984 and 66145 for callers by
+            // explicitly raising system_error here.
+            throw std::system_error(rc, std::generic_category());
         }
-        break;
+
+        --retries;
+        std::this_thread::sleep_for(delay);
     }
 }
 
@@ -221,4 +350,18 @@ std::string HwmonIO::path() const
     return p;
 }
 
+void HwmonIO::readBatch(
+        const std::vector<Attribute>& attributes,
+        std::vector<int64_t>& values,
+        std::vector<int>& errors) const
+{
+    values.resize(attributes.size());
+    errors.resize(attributes.size());
+
+    for (size_t i = 0; i < attributes.size(); ++i)
+    {
+        errors[i] = readOnce(attributes[i], values[i]);
+    }
+}
+
 } // hwmonio
@@ -2,12 +2,73 @@
 
 #include <chrono>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace hwmonio {
 
 static constexpr auto retries = 10;
 static constexpr auto delay = std::chrono::milliseconds{100};
 
+/** @brief Check if an error from a hwmon attribute access may be transient.
+ *
+ *  @param[in] rc - The errno value of the failed access.
+ *
+ *  @return true if the access is worth retrying.
+ */
+bool isRetryable(int rc);
+
+/** @brief Check if an error from a hwmon attribute access means the
+ *         device is gone.
+ *
+ *  @param[in] rc - The errno value of the failed access.
+ *
+ *  @return true if the directory or the device disappeared.
+ */
+bool isGone(int rc);
+
+/** @class FileDescriptor
+ *  @brief Owns an open file descriptor and closes it on destruction.
+ */
+class FileDescriptor
+{
+    public:
+        FileDescriptor() = default;
+        FileDescriptor(const FileDescriptor&) = delete;
+        FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+        /** @brief Constructor
+         *
+         *  @param[in] fd - The descriptor to take ownership of.
+         */
+        explicit FileDescriptor(int fd) : fd(fd)
+        {
+        }
+
+        FileDescriptor(FileDescriptor&& other) noexcept : fd(other.fd)
+        {
+            other.fd = -1;
+        }
+
+        FileDescriptor& operator=(FileDescriptor&& other) noexcept;
+
+        ~FileDescriptor();
+
+        /** @brief Access the raw descriptor. */
+        int operator()() const
+        {
+            return fd;
+        }
+
+        explicit operator bool() const
+        {
+            return fd >= 0;
+        }
+
+    private:
+        int fd = -1;
+};
+
 /** @class HwmonIOInterface
  *  @brief Abstract base class defining a HwmonIOInterface.
  *
@@ -17,6 +78,9 @@ static constexpr auto delay = std::chrono::milliseconds{100};
 class HwmonIOInterface
 {
     public:
+        /** @brief Handle to an attribute, from attribute(). */
+        using Attribute = size_t;
+
         virtual ~HwmonIOInterface() = default;
 
         virtual int64_t read(
@@ -27,7 +91,7 @@ class HwmonIOInterface
                 std::chrono::milliseconds delay) const = 0;
 
         virtual void write(
-                uint32_t val,
+                int64_t val,
                 const std::string& type,
                 const std::string& id,
                 const std::string& sensor,
@@ -35,24 +99,33 @@ class HwmonIOInterface
                 std::chrono::milliseconds delay) const = 0;
 
         virtual std::string path() const = 0;
+
+        virtual Attribute attribute(
+                const std::string& type,
+                const std::string& id,
+                const std::string& sensor) const = 0;
+
+        virtual void readBatch(
+                const std::vector<Attribute>& attributes,
+                std::vector<int64_t>& values,
+                std::vector<int>& errors) const = 0;
 };
 
 /** @class HwmonIO
  *  @brief Convenience wrappers for HWMON sysfs attribute IO.
  *
- *  Unburden the rest of the application from having to check
- *  ENOENT after every hwmon attribute io operation.  Hwmon
- *  device drivers can be unbound at any time; the program
+ *  Hwmon device drivers can be unbound at any time; the program
  *  cannot always be terminated externally before we try to
- *  do an io.
+ *  do an io.  Such an io fails with ENOENT or ENODEV, see isGone(),
+ *  and is left to the caller to stop monitoring the device.
  */
 class HwmonIO : public HwmonIOInterface
 {
     public:
         HwmonIO() = delete;
-        HwmonIO(const HwmonIO&) = default;
+        HwmonIO(const HwmonIO&) = delete;
         HwmonIO(HwmonIO&&) = default;
-        HwmonIO& operator=(const HwmonIO&) = default;
+        HwmonIO& operator=(const HwmonIO&) = delete;
         HwmonIO& operator=(HwmonIO&&) = default;
         ~HwmonIO() = default;
 
@@ -65,14 +138,16 @@ class HwmonIO : public HwmonIOInterface
 
         /** @brief Perform formatted hwmon sysfs read.
          *
-         *  Propagates any exceptions other than ENOENT.
-         *  ENOENT will result in a call to exit(0) in case
-         *  the underlying hwmon driver is unbound and
-         *  the program is inadvertently left running.
+         *  Propagates any exceptions.  ENOENT and ENODEV, in case
+         *  the underlying hwmon driver is unbound and the program
+         *  is inadvertently left running, are thrown without retries.
          *
          *  For possibly transient errors will retry up to
          *  the specified number of times.
          *
+         *  The attribute is opened on first use and the descriptor
+         *  is kept open for subsequent reads.
+         *
          *  @param[in] type - The hwmon type (ex. temp).
          *  @param[in] id - The hwmon id (ex. 1).
          *  @param[in] sensor - The hwmon sensor (ex. input).
@@ -88,12 +163,25 @@ class HwmonIO : public HwmonIOInterface
                 size_t retries,
                 std::chrono::milliseconds delay) const override;
 
+        /** @brief Perform a single formatted hwmon sysfs read attempt.
+         *
+         *  Unlike read(), errors are returned rather than retried or
+         *  thrown, so callers can schedule their own retries without
+         *  blocking.  Callers check errors with isGone() to notice the
+         *  device went away.
+         *
+         *  @param[in] attr - The attribute, from attribute().
+         *  @param[out] val - The read value.
+         *
+         *  @return errno - Zero on success.
+         */
+        int tryRead(Attribute attr, int64_t& val) const;
+
         /** @brief Perform formatted hwmon sysfs write.
          *
-         *  Propagates any exceptions other than ENOENT.
-         *  ENOENT will result in a call to exit(0) in case
-         *  the underlying hwmon driver is unbound and
-         *  the program is inadvertently left running.
+         *  Propagates any exceptions.  ENOENT and ENODEV, in case
+         *  the underlying hwmon driver is unbound and the program
+         *  is inadvertently left running, are thrown without retries.
          *
          *  For possibly transient errors will retry up to
          *  the specified number of times.
@@ -105,7 +193,7 @@ class HwmonIO : public HwmonIOInterface
          *  @param[in] delay - The time to sleep between retry attempts.
          */
         void write(
-                uint32_t val,
+                int64_t val,
                 const std::string& type,
                 const std::string& id,
                 const std::string& sensor,
@@ -119,8 +207,131 @@ class HwmonIO : public HwmonIOInterface
          */
         std::string path() const override;
 
+        /** @brief Resolve a hwmon attribute to a handle for readBatch().
+         *
+         *  Handles remain valid for the lifetime of this object, so
+         *  callers can resolve the attributes they poll once and
+         *  reuse the list.
+         *
+         *  @param[in] type - The hwmon type (ex. temp).
+         *  @param[in] id - The hwmon id (ex. 1).
+         *  @param[in] sensor - The hwmon sensor (ex. input).
+         *
+         *  @return attribute - The attribute handle.
+         */
+        Attribute attribute(
+                const std::string& type,
+                const std::string& id,
+                const std::string& sensor) const override;
+
+        /** @brief Read a list of attributes in one call.
+         *
+         *  Each attribute is read once, without retries.  The
+         *  outcome of each read is returned in the entry of errors
+         *  at the same position, zero on success.  ENOENT and
+         *  ENODEV are returned too, it's up to the caller to stop
+         *  monitoring a device that is gone, from its own thread.
+         *
+         *  The output vectors are resized to match attributes, so
+         *  reusing them across calls avoids any allocation.
+         *
+         *  @param[in] attributes - The attributes to read.
+         *  @param[out] values - The read values.
+         *  @param[out] errors - The errno of each read.
+         */
+        void readBatch(
+                const std::vector<Attribute>& attributes,
+                std::vector<int64_t>& values,
+                std::vector<int>& errors) const override;
+
+    protected:
+        /** @brief Read buffer size, enough for any decimal int64_t. */
+        static constexpr size_t bufSize = 32;
+
+        /** @brief Check if an error means a descriptor is stale.
+         *
+         *  @param[in] rc - The errno value of the failed read.
+         *
+         *  @return true if the attribute should be reopened.
+         */
+        static bool isStale(int rc);
+
+        /** @brief Parse a decimal attribute value.
+         *
+         *  @param[in] buf - The read data, with room for a terminator
+         *                   at buf[len].
+         *  @param[in] len - The number of bytes read.
+         *  @param[out] val - The parsed value.
+         *
+         *  @return errno - Zero on success.
+         */
+        static int parse(char* buf, size_t len, int64_t& val);
+
+        /** @brief Single attempt at reading an attribute.
+         *
+         *  A stale descriptor (ENODEV, ENOENT or EBADF) is
+         *  dropped and the attribute is reopened once.
+         *
+         *  @param[in] attribute - The attribute handle.
+         *  @param[out] val - The read value.
+         *
+         *  @return errno - Zero on success.
+         */
+        int readOnce(Attribute attribute, int64_t& val) const;
+
+        /** @brief Find or open the descriptor of an attribute.
+         *
+         *  @param[in] attribute - The attribute handle.
+         *
+         *  @return fd - The descriptor, or -1 with errno set.
+         */
+        int open(Attribute attribute) const;
+
+        /** @brief Close the descriptor of an attribute. */
+        void close(Attribute attribute) const;
+
     private:
+        using Cache = std::unordered_map<std::string, FileDescriptor>;
+
+        /** @brief Find or open a cached attribute descriptor.
+         *
+         *  @param[in] cache - The descriptor cache to use.
+         *  @param[in] path - The attribute sysfs path.
+         *  @param[in] flags - The open(2) flags for a cache miss.
+         *
+         *  @return fd - The descriptor, or -1 with errno set.
+         */
+        static int open(Cache& cache, const std::string& path, int flags);
+
+        /** @brief Resolve an attribute path to a handle. */
+        Attribute attribute(const std::string& path) const;
+
+        /** @brief Single attempt at writing an attribute.
+         *
+         *  @param[in] path - The attribute sysfs path.
+         *  @param[in] val - The value to write.
+         *
+         *  @return errno - Zero on success.
+         */
+        int writeOnce(const std::string& path, int64_t val) const;
+
         std::string p;
+
+        /** @brief An attribute that has been read. */
+        struct Slot
+        {
+            std::string path;
+            FileDescriptor fd;
+        };
+
+        /** @brief Attributes that have been read, indexed by handle. */
+        mutable std::vector<Slot> slots;
+
+        /** @brief Attribute handles, keyed by path. */
+        mutable std::unordered_map<std::string, Attribute> handles;
+
+        /** @brief Open descriptors for attributes that have been written. */
+        mutable Cache writeFds;
 };
 } // namespace hwmonio
 
@@ -0,0 +1,237 @@
+/**
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <sys/uio.h>
+#include <system_error>
+
+#include <phosphor-logging/log.hpp>
+
+#include "config.h"
+#include "hwmonio_uring.hpp"
+
+namespace hwmonio {
+
+using namespace phosphor::logging;
+
+constexpr unsigned HwmonIOUring::default_depth;
+
+HwmonIOUring::Ring::Ring(unsigned depth)
+{
+    auto r = io_uring_queue_init(depth, &ring, 0);
+    if (r < 0)
+    {
+        throw std::system_error(-r, std::generic_category());
+    }
+}
+
+HwmonIOUring::Ring::~Ring()
+{
+    io_uring_queue_exit(&ring);
+}
+
+bool HwmonIOUring::Ring::reserve(size_t count)
+{
+    if (buffers.size() >= count * bufSize)
+    {
+        return true;
+    }
+
+    if (!buffers.empty())
+    {
+        io_uring_unregister_buffers(&ring);
+    }
+
+    buffers.resize(count * bufSize);
+
+    iovec iov;
+    iov.iov_base = buffers.data();
+    iov.iov_len = buffers.size();
+
+    auto r = io_uring_register_buffers(&ring, &iov, 1);
+    if (r < 0)
+    {
+        buffers.clear();
+        return false;
+    }
+
+    return true;
+}
+
+HwmonIOUring::HwmonIOUring(const std::string& path, unsigned depth) :
+    HwmonIO(path),
+    depth(depth)
+{
+    try
+    {
+        idle.push_back(std::make_unique<Ring>(depth));
+        ready = true;
+    }
+    catch (const std::system_error& e)
+    {
+        log<level::INFO>("io_uring unavailable, using synchronous reads",
+                entry("ERRNO=%d", e.code().value()));
+    }
+}
+
+HwmonIOUring::~HwmonIOUring() = default;
+
+std::unique_ptr<HwmonIOUring::Ring> HwmonIOUring::acquire() const
+{
+    {
+        std::lock_guard<std::mutex> l(lock);
+        if (!idle.empty())
+        {
+            auto ring = std::move(idle.back());
+            idle.pop_back();
+            return ring;
+        }
+    }
+
+    // Another caller has the rings, set up one more for this one.
+    try
+    {
+        return std::make_unique<Ring>(depth);
+    }
+    catch (const std::system_error& e)
+    {
+        return nullptr;
+    }
+}
+
+void HwmonIOUring::release(std::unique_ptr<Ring> ring) const
+{
+    std::lock_guard<std::mutex> l(lock);
+    idle.push_back(std::move(ring));
+}
+
+void HwmonIOUring::submit(
+        Ring& r,
+        const std::vector<Attribute>& attributes,
+        size_t begin,
+        size_t end,
+        std::vector<int64_t>& values,
+        std::vector<int>& errors) const
+{
+    unsigned queued = 0;
+
+    for (auto i = begin; i < end; ++i)
+    {
+        auto fd = open(attributes[i]);
+        if (fd < 0)
+        {
+            errors[i] = errno;
+            continue;
+        }
+
+        auto sqe = io_uring_get_sqe(&r.ring);
+        io_uring_prep_read_fixed(
+                sqe, fd, &r.buffers[i * bufSize], bufSize - 1, 0, 0);
+        io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(i));
+        ++queued;
+    }
+
+    if (!queued)
+    {
+        return;
+    }
+
+    int rc;
+    do
+    {
+        rc = io_uring_submit_and_wait(&r.ring, queued);
+    } while (rc == -EINTR);
+
+    if (rc < 0)
+    {
+        throw std::system_error(-rc, std::generic_category());
+    }
+
+    while (queued)
+    {
+        io_uring_cqe* cqe = nullptr;
+        rc = io_uring_wait_cqe(&r.ring, &cqe);
+        if (rc < 0)
+        {
+            if (rc == -EINTR || rc == -EAGAIN)
+            {
+                continue;
+            }
+            throw std::system_error(-rc, std::generic_category());
+        }
+
+        auto i = reinterpret_cast<size_t>(io_uring_cqe_get_data(cqe));
+        auto res = cqe->res;
+        io_uring_cqe_seen(&r.ring, cqe);
+        --queued;
+
+        if (res < 0)
+        {
+            // A stale descriptor is reopened by the synchronous path.
+            errors[i] = isStale(-res) ?
+                    readOnce(attributes[i], values[i]) : -res;
+            continue;
+        }
+
+        errors[i] = parse(&r.buffers[i * bufSize], res, values[i]);
+    }
+}
+
+void HwmonIOUring::readBatch(
+        const std::vector<Attribute>& attributes,
+        std::vector<int64_t>& values,
+        std::vector<int>& errors) const
+{
+    auto ring = ready ? acquire() : nullptr;
+    if (!ring || !ring->reserve(attributes.size()))
+    {
+        if (ring)
+        {
+            release(std::move(ring));
+        }
+        HwmonIO::readBatch(attributes, values, errors);
+        return;
+    }
+
+    values.resize(attributes.size());
+    errors.resize(attributes.size());
+
+    for (size_t begin = 0; begin < attributes.size(); begin += depth)
+    {
+        auto end = std::min(attributes.size(), begin + depth);
+        try
+        {
+            submit(*ring, attributes, begin, end, values, errors);
+        }
+        catch (const std::system_error& e)
+        {
+            // A ring that fails may still have reads in flight, so it's
+            // dropped rather than reused, and the rest of the batch is
+            // read as HwmonIO::readBatch would.
+            log<level::ERR>("io_uring read failed, reading synchronously",
+                    entry("ERRNO=%d", e.code().value()));
+            ring.reset();
+
+            for (auto i = begin; i < attributes.size(); ++i)
+            {
+                errors[i] = readOnce(attributes[i], values[i]);
+            }
+            return;
+        }
+    }
+    release(std::move(ring));
+}
+
+} // namespace hwmonio
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <liburing.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "hwmonio.hpp"
+
+namespace hwmonio {
+
+/** @class HwmonIOUring
+ *  @brief HwmonIO that submits batch reads through io_uring.
+ *
+ *  All the attributes of a batch are queued as fixed buffer reads
+ *  on the cached attribute descriptors and submitted together, so
+ *  drivers that can service requests in parallel are no longer
+ *  limited by one blocking read at a time.  Single attribute access
+ *  and writes are inherited from HwmonIO.
+ *
+ *  Each concurrent caller, such as a ReadPool thread, gets a ring of
+ *  its own, so batches read on several threads don't wait on each
+ *  other.  Rings are reused, there are at most as many as callers
+ *  were ever reading at once.
+ *
+ *  If the kernel doesn't support io_uring, batch reads fall back
+ *  to the synchronous HwmonIO implementation.
+ */
+class HwmonIOUring : public HwmonIO
+{
+    public:
+        HwmonIOUring() = delete;
+        HwmonIOUring(const HwmonIOUring&) = delete;
+        HwmonIOUring(HwmonIOUring&&) = delete;
+        HwmonIOUring& operator=(const HwmonIOUring&) = delete;
+        HwmonIOUring& operator=(HwmonIOUring&&) = delete;
+        ~HwmonIOUring();
+
+        /** @brief Default maximum number of reads in flight at once. */
+        static constexpr unsigned default_depth = 64;
+
+        /** @brief Constructor
+         *
+         *  @param[in] path - hwmon instance root - eg:
+         *      /sys/class/hwmon/hwmon<N>
+         *  @param[in] depth - maximum number of reads in flight at
+         *      once, on each ring
+         */
+        explicit HwmonIOUring(const std::string& path,
+                              unsigned depth = default_depth);
+
+        /** @brief Read a list of attributes in io_uring submissions of
+         *         up to depth reads.
+         *
+         *  See HwmonIO::readBatch.  If the ring fails, it's dropped
+         *  and the rest of the batch is read synchronously.
+         */
+        void readBatch(
+                const std::vector<Attribute>& attributes,
+                std::vector<int64_t>& values,
+                std::vector<int>& errors) const override;
+
+    private:
+        /** @brief A ring and its registered read buffers. */
+        struct Ring
+        {
+            Ring() = delete;
+            Ring(const Ring&) = delete;
+            Ring& operator=(const Ring&) = delete;
+            ~Ring();
+
+            /** @brief Set up a ring, throwing std::system_error if
+             *         io_uring can't be.
+             *
+             *  @param[in] depth - Number of submission queue entries.
+             */
+            explicit Ring(unsigned depth);
+
+            /** @brief The submission and completion rings. */
+            io_uring ring;
+
+            /** @brief Registered read buffers, bufSize bytes per
+             *         position. */
+            std::vector<char> buffers;
+
+            /** @brief Grow the registered read buffers to fit a batch.
+             *
+             *  @param[in] count - The number of attributes in the batch.
+             *
+             *  @return true if the buffers are registered.
+             */
+            bool reserve(size_t count);
+        };
+
+        /** @brief Take an idle ring, setting up a new one if none are.
+         *
+         *  @return The ring, nothing if io_uring can't be set up.
+         */
+        std::unique_ptr<Ring> acquire() const;
+
+        /** @brief Return a ring taken with acquire(). */
+        void release(std::unique_ptr<Ring> ring) const;
+
+        /** @brief Submit and reap the reads of part of a batch.
+         *
+         *  @param[in] ring - The ring to read on.
+         *  @param[in] attributes - The attributes of the batch.
+         *  @param[in] begin - The first position to read.
+         *  @param[in] end - One past the last position to read.
+         *  @param[out] values - The read values.
+         *  @param[out] errors - The errno of each read.
+         */
+        void submit(
+                Ring& ring,
+                const std::vector<Attribute>& attributes,
+                size_t begin,
+                size_t end,
+                std::vector<int64_t>& values,
+                std::vector<int>& errors) const;
+
+        /** @brief Maximum number of reads in flight at once, per ring. */
+        const unsigned depth;
+
+        /** @brief Whether io_uring could be set up at all. */
+        bool ready = false;
+
+        /** @brief Rings not in use by a caller. */
+        mutable std::vector<std::unique_ptr<Ring>> idle;
+
+        /** @brief Protects the idle rings. */
+        mutable std::mutex lock;
+};
+
+} // namespace hwmonio
+
+// vim: tabstop=8 expandtab shiftwidth=4 softtabstop=4
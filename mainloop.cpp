@@ -13,10 +13,16 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <memory>
+#include <csignal>
 #include <cstdlib>
+#include <experimental/filesystem>
+#include <fstream>
 #include <string>
 #include <unordered_set>
 #include <sstream>
@@ -26,19 +32,188 @@
 #include "env.hpp"
 #include "fan_pwm.hpp"
 #include "fan_speed.hpp"
+#include "chip_thresholds.hpp"
 #include "hwmon.hpp"
 #include "hwmonio.hpp"
+#ifdef HAVE_LIBURING
+#include "hwmonio_uring.hpp"
+#endif
 #include "sensorset.hpp"
 #include "sysfs.hpp"
 #include "mainloop.hpp"
+#include "readpool.hpp"
 #include "targets.hpp"
 #include "thresholds.hpp"
+#include "timerwheel.hpp"
+#include "pollstats.hpp"
+#include "hotplug.hpp"
+#include "notify.hpp"
+#include "propertysignals.hpp"
 #include "sensor.hpp"
+#include "sensorhistory.hpp"
+#include "sensortable.hpp"
 
 #include <xyz/openbmc_project/Sensor/Device/error.hpp>
 
 using namespace phosphor::logging;
 
+static constexpr auto valueIfaceName = "xyz.openbmc_project.Sensor.Value";
+static constexpr auto statusIfaceName =
+    "xyz.openbmc_project.State.Decorator.OperationalStatus";
+
+/** @brief The chip limits of the threshold alarms, by alarm bit. */
+static constexpr const char* limitAttributes[] =
+{
+    "min", "max", "lcrit", "crit",
+};
+
+/** @brief The alarm attributes of the threshold alarms, by alarm bit. */
+static constexpr const char* alarmAttributes[] =
+{
+    hwmon::entry::cminalarm,
+    hwmon::entry::cmaxalarm,
+    hwmon::entry::clcritalarm,
+    hwmon::entry::ccritalarm,
+};
+
+/** @brief Get an interface of an object, if it has it. */
+template <typename T>
+static T* getInterface(Object& obj, InterfaceType type)
+{
+    auto it = obj.find(type);
+    if (it == obj.end())
+    {
+        return nullptr;
+    }
+    return std::experimental::any_cast<std::shared_ptr<T>>(it->second).get();
+}
+
+/** @brief Check a sensor reading against its thresholds, reporting
+ *         any alarms that changed.
+ */
+template <typename T>
+static void checkThresholds(
+        T& iface,
+        int64_t value,
+        std::pair<bool, bool> hardware,
+        std::pair<bool, bool> chip,
+        const hwmon::AlarmFilter& filter,
+        phosphor::hwmon::PropertySignals& signals,
+        const std::string& path)
+{
+    auto changed = checkThresholds(iface, value, hardware, chip, &filter);
+    if (changed.first)
+    {
+        signals.changed(path,
+                        Thresholds<T>::interface,
+                        Thresholds<T>::alarmLoProperty);
+    }
+    if (changed.second)
+    {
+        signals.changed(path,
+                        Thresholds<T>::interface,
+                        Thresholds<T>::alarmHiProperty);
+    }
+}
+
+/** @brief Check if new settings change a sensor's interfaces. */
+static bool reshaped(const config::Sensor& from, const config::Sensor& to)
+{
+    return from.mode != to.mode ||
+           from.maxValue != to.maxValue ||
+           from.minValue != to.minValue ||
+           from.pwmTarget != to.pwmTarget ||
+           from.enable != to.enable;
+}
+
+/** @brief The number of readings of a sensor to keep. */
+static size_t historySize(const config::Device& device,
+                          const SensorSet::key_type& sensor)
+{
+    auto& history = device.sensor(sensor).history;
+    return history ? *history : device.history.value_or(0);
+}
+
+/** @brief Check if new settings change a sensor's path or thresholds,
+ *         which are looked up by the sensor's (indirect) id.
+ */
+static bool relabeled(const config::Sensor& from, const config::Sensor& to)
+{
+    return from.label != to.label ||
+           (from.warnLo && from.warnHi) != (to.warnLo && to.warnHi) ||
+           (from.critLo && from.critHi) != (to.critLo && to.critHi);
+}
+
+/** @brief Set a sensor's thresholds from new settings. */
+template <typename T>
+static void setThresholds(T* iface, const config::Sensor& config)
+{
+    auto& lo = config.*Thresholds<T>::configLo;
+    auto& hi = config.*Thresholds<T>::configHi;
+    if (iface && lo && hi)
+    {
+        (iface->*Thresholds<T>::setLo)(*lo);
+        (iface->*Thresholds<T>::setHi)(*hi);
+    }
+}
+
+/** @brief Call back when a sensor's thresholds are set. */
+template <typename T>
+static void watchThresholds(T* iface, std::function<void(bool)> callback)
+{
+    if (iface)
+    {
+        static_cast<typename Thresholds<T>::Server*>(iface)->onChange(
+                std::move(callback));
+    }
+}
+
+/** @brief Set a sensor's threshold alarms from alarm bits, only
+ *         those in mask.
+ */
+template <typename T>
+static void setAlarms(T* iface, uint8_t alarms, uint8_t lo, uint8_t hi,
+                      uint8_t mask = 0xff)
+{
+    static constexpr auto skipSignal = true;
+
+    if (iface)
+    {
+        if (mask & lo)
+        {
+            (iface->*Thresholds<T>::alarmLo)(alarms & lo, skipSignal);
+        }
+        if (mask & hi)
+        {
+            (iface->*Thresholds<T>::alarmHi)(alarms & hi, skipSignal);
+        }
+    }
+}
+
+/** @brief Keep a sensor's previous alarm filter, if it was set up
+ *         with the same hysteresis and debounce.
+ */
+static void keepFilter(hwmon::AlarmFilter& filter,
+                       const hwmon::AlarmFilter& previous)
+{
+    if (filter.hysteresis == previous.hysteresis &&
+        filter.debounce == previous.debounce)
+    {
+        filter = previous;
+    }
+}
+
+static uint64_t gcd(uint64_t a, uint64_t b)
+{
+    while (b)
+    {
+        auto t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
 // Initialization for Warning Objects
 decltype(Thresholds<WarningObject>::setLo) Thresholds<WarningObject>::setLo =
     &WarningObject::warningLow;
@@ -52,6 +227,16 @@ decltype(Thresholds<WarningObject>::alarmLo) Thresholds<WarningObject>::alarmLo
     &WarningObject::warningAlarmLow;
 decltype(Thresholds<WarningObject>::alarmHi) Thresholds<WarningObject>::alarmHi =
     &WarningObject::warningAlarmHigh;
+decltype(Thresholds<WarningObject>::getAlarmLo) Thresholds<WarningObject>::getAlarmLo =
+    &WarningObject::warningAlarmLow;
+decltype(Thresholds<WarningObject>::getAlarmHi) Thresholds<WarningObject>::getAlarmHi =
+    &WarningObject::warningAlarmHigh;
+decltype(Thresholds<WarningObject>::configLo) Thresholds<WarningObject>::configLo =
+    &config::Sensor::warnLo;
+decltype(Thresholds<WarningObject>::configHi) Thresholds<WarningObject>::configHi =
+    &config::Sensor::warnHi;
+decltype(Thresholds<WarningObject>::configHyst) Thresholds<WarningObject>::configHyst =
+    &config::Sensor::warnHyst;
 
 // Initialization for Critical Objects
 decltype(Thresholds<CriticalObject>::setLo) Thresholds<CriticalObject>::setLo =
@@ -66,6 +251,16 @@ decltype(Thresholds<CriticalObject>::alarmLo) Thresholds<CriticalObject>::alarmL
     &CriticalObject::criticalAlarmLow;
 decltype(Thresholds<CriticalObject>::alarmHi) Thresholds<CriticalObject>::alarmHi =
     &CriticalObject::criticalAlarmHigh;
+decltype(Thresholds<CriticalObject>::getAlarmLo) Thresholds<CriticalObject>::getAlarmLo =
+    &CriticalObject::criticalAlarmLow;
+decltype(Thresholds<CriticalObject>::getAlarmHi) Thresholds<CriticalObject>::getAlarmHi =
+    &CriticalObject::criticalAlarmHigh;
+decltype(Thresholds<CriticalObject>::configLo) Thresholds<CriticalObject>::configLo =
+    &config::Sensor::critLo;
+decltype(Thresholds<CriticalObject>::configHi) Thresholds<CriticalObject>::configHi =
+    &config::Sensor::critHi;
+decltype(Thresholds<CriticalObject>::configHyst) Thresholds<CriticalObject>::configHyst =
+    &config::Sensor::critHyst;
 
 std::string MainLoop::getID(SensorSet::container_t::const_reference sensor)
 {
@@ -84,7 +279,7 @@ std::string MainLoop::getID(SensorSet::container_t::const_reference sensor)
      * name the object: LABEL_temp5 = "My DBus object name".
      *
      */
-    auto mode = env::getEnv("MODE", sensor.first);
+    const auto& mode = _config.sensor(sensor.first).mode;
     if (!mode.empty())
     {
         id = env::getIndirectID(
@@ -114,7 +309,7 @@ SensorIdentifiers MainLoop::getIdentifiers(
     if (!id.empty())
     {
         // Ignore inputs without a label.
-        label = env::getEnv("LABEL", sensor.first.first, id);
+        label = _config.sensor(sensor.first.first, id).label;
     }
 
     return std::make_tuple(std::move(id),
@@ -130,7 +325,9 @@ SensorIdentifiers MainLoop::getIdentifiers(
  * data is then returned for sensor state monitoring within the main loop.
  */
 optional_ns::optional<ObjectStateData> MainLoop::getObject(
-        SensorSet::container_t::const_reference sensor)
+        SensorSet::container_t::const_reference sensor,
+        const phosphor::hwmon::snapshot::Entry* restored,
+        const Prefetch* prefetched)
 {
     auto properties = getIdentifiers(sensor);
     if (std::get<sensorID>(properties).empty() ||
@@ -145,14 +342,14 @@ optional_ns::optional<ObjectStateData> MainLoop::getObject(
         return {};
     }
 
+    auto& sensorConfig = _config.sensor(sensor.first);
     auto sensorObj = std::make_unique<sensor::Sensor>(sensor.first,
-                                                      ioAccess,
-                                                      _devPath);
+                                                      *ioAccess,
+                                                      _devPath,
+                                                      sensorConfig);
 
-    // Get list of return codes for removing sensors on device
-    auto devRmRCs = env::getEnv("REMOVERCS");
     // Add sensor removal return codes defined at the device level
-    sensorObj->addRemoveRCs(devRmRCs);
+    sensorObj->addRemoveRCs(_config.removeRCs);
 
     std::string objectPath{_root};
     objectPath.append(1, '/');
@@ -161,6 +358,36 @@ optional_ns::optional<ObjectStateData> MainLoop::getObject(
     objectPath.append(std::get<sensorLabel>(properties));
 
     ObjectInfo info(&_bus, std::move(objectPath), Object());
+    created.insert(sensor.first);
+
+    // The snapshot is of no use if the sensor's object has moved.
+    if (restored && restored->path != std::get<std::string>(info))
+    {
+        restored = nullptr;
+    }
+
+    optional_ns::optional<bool> functional;
+    optional_ns::optional<int64_t> value;
+    if (restored)
+    {
+        functional = restored->functional;
+        value = restored->value;
+    }
+    else if (prefetched)
+    {
+        // Failed reads are done again below, with retries and the
+        // usual error handling.
+        auto& fault = prefetched->fault;
+        if (fault && !fault->first)
+        {
+            functional = (fault->second == 0);
+        }
+        if ((!fault || functional == true) && !prefetched->input.first)
+        {
+            value = sensorObj->adjustValue(prefetched->input.second);
+        }
+    }
+
     RetryIO retryIO(hwmonio::retries, hwmonio::delay);
     if (rmSensors.find(sensor.first) != rmSensors.end())
     {
@@ -173,13 +400,19 @@ optional_ns::optional<ObjectStateData> MainLoop::getObject(
     try
     {
         // Add status interface based on _fault file being present
-        sensorObj->addStatus(info);
-        valueInterface = sensorObj->addValue(retryIO, info);
+        sensorObj->addStatus(info, functional);
+        valueInterface = sensorObj->addValue(retryIO, info, value);
     }
     catch (const std::system_error& e)
     {
+        if (hwmonio::isGone(e.code().value()))
+        {
+            gone();
+            return {};
+        }
+
         auto file = sysfs::make_sysfs_path(
-                ioAccess.path(),
+                ioAccess->path(),
                 sensor.first.first,
                 sensor.first.second,
                 hwmon::entry::cinput);
@@ -211,29 +444,111 @@ optional_ns::optional<ObjectStateData> MainLoop::getObject(
 
         log<level::INFO>("Logging failing sysfs file",
                 entry("FILE=%s", file.c_str()));
-#ifdef REMOVE_ON_FAIL
-        return {}; /* skip adding this sensor for now. */
-#else
-        exit(EXIT_FAILURE);
+#ifndef REMOVE_ON_FAIL
+        stop(EXIT_FAILURE);
 #endif
+        return {}; /* skip adding this sensor for now. */
     }
     auto sensorValue = valueInterface->value();
-    addThreshold<WarningObject>(sensor.first.first,
-                                std::get<sensorID>(properties),
-                                sensorValue,
-                                info);
-    addThreshold<CriticalObject>(sensor.first.first,
-                                 std::get<sensorID>(properties),
-                                 sensorValue,
-                                 info);
+    auto thresholdConfig = _config.sensor(sensor.first.first,
+                                          std::get<sensorID>(properties));
+    uint8_t chip = 0;
+    uint8_t limits = 0;
+    if (_config.chipThresholds)
+    {
+        chip = chipThresholds(sensor, *sensorObj, thresholdConfig, limits);
+    }
+
+    // Thresholds taken from the chip are written back to it when set.
+    auto chipLimits = [&](size_t lo)
+    {
+        return hwmon::ChipLimits(
+                std::make_unique<hwmonio::HwmonIO>(ioAccess->path()),
+                _devPath,
+                sensor.first,
+                sensorObj->getAdjusts(),
+                (limits & (1 << lo)) ? limitAttributes[lo] : nullptr,
+                (limits & (2 << lo)) ? limitAttributes[lo + 1] : nullptr);
+    };
+    if (limits & (WARN_LO | WARN_HI))
+    {
+        addThreshold<WarningObject, hwmon::ChipWarning>(
+                thresholdConfig, sensorValue, info, chipLimits(0),
+                *thresholdConfig.warnLo, *thresholdConfig.warnHi);
+    }
+    else
+    {
+        addThreshold<WarningObject>(thresholdConfig, sensorValue, info);
+    }
+    if (limits & (CRIT_LO | CRIT_HI))
+    {
+        addThreshold<CriticalObject, hwmon::ChipCritical>(
+                thresholdConfig, sensorValue, info, chipLimits(2),
+                *thresholdConfig.critLo, *thresholdConfig.critHi);
+    }
+    else
+    {
+        addThreshold<CriticalObject>(thresholdConfig, sensorValue, info);
+    }
+
+    auto& obj = std::get<Object>(info);
+    watchThresholds(getInterface<WarningObject>(obj, InterfaceType::WARN),
+                    std::bind(&MainLoop::thresholdsChanged, this,
+                              sensor.first, InterfaceType::WARN,
+                              std::placeholders::_1));
+    watchThresholds(getInterface<CriticalObject>(obj, InterfaceType::CRIT),
+                    std::bind(&MainLoop::thresholdsChanged, this,
+                              sensor.first, InterfaceType::CRIT,
+                              std::placeholders::_1));
+
+    if (chip)
+    {
+        // The alarms left to the chip start out as the chip has them.
+        uint8_t raised = 0;
+        for (size_t n = 0; n < 4; ++n)
+        {
+            if (!(chip & (1 << n)))
+            {
+                continue;
+            }
+            auto attr = ioAccess->attribute(sensor.first.first,
+                                            sensor.first.second,
+                                            alarmAttributes[n]);
+            int64_t alarm = 0;
+            if (!ioAccess->tryRead(attr, alarm) && alarm)
+            {
+                raised |= 1 << n;
+            }
+        }
+        setAlarms(getInterface<WarningObject>(obj, InterfaceType::WARN),
+                  raised, WARN_LO, WARN_HI, chip);
+        setAlarms(getInterface<CriticalObject>(obj, InterfaceType::CRIT),
+                  raised, CRIT_LO, CRIT_HI, chip);
+    }
+
+    if (restored)
+    {
+        // The saved value may no longer hold, so the alarms compared
+        // against it are left to the first reading.
+        setAlarms(getInterface<WarningObject>(obj, InterfaceType::WARN),
+                  0, WARN_LO, WARN_HI, ~chip);
+        setAlarms(getInterface<CriticalObject>(obj, InterfaceType::CRIT),
+                  0, CRIT_LO, CRIT_HI, ~chip);
+    }
 
+    // A failed write stops only this device.
+    auto failed = std::bind(&MainLoop::stop, this, EXIT_FAILURE);
     auto target = addTarget<hwmon::FanSpeed>(
-            sensor.first, ioAccess, _devPath, info);
-    if (target)
+            sensor.first, *ioAccess, _devPath, _config, info, failed);
+    if (target && sensorConfig.enable)
     {
-        target->enable();
+        target->enable(*sensorConfig.enable);
     }
-    addTarget<hwmon::FanPwm>(sensor.first, ioAccess, _devPath, info);
+    addTarget<hwmon::FanPwm>(
+            sensor.first, *ioAccess, _devPath, _config, info, failed);
+
+    // Announced along with the object.
+    addHistory(sensor.first, std::get<std::string>(info), _config, false);
 
     // All the interfaces have been created.  Go ahead
     // and emit InterfacesAdded.
@@ -241,6 +556,14 @@ optional_ns::optional<ObjectStateData> MainLoop::getObject(
 
     // Save sensor object specifications
     sensorObjects[sensor.first] = std::move(sensorObj);
+    if (chip)
+    {
+        chipAlarms[sensor.first] = chip;
+    }
+    else
+    {
+        chipAlarms.erase(sensor.first);
+    }
 
     return std::make_pair(std::move(std::get<sensorLabel>(properties)),
                           std::move(info));
@@ -253,16 +576,59 @@ MainLoop::MainLoop(
     const std::string& devPath,
     const char* prefix,
     const char* root)
-    : _bus(std::move(bus)),
-      _manager(_bus, root),
+    : MainLoop(std::make_unique<sdbusplus::bus::bus>(std::move(bus)),
+               nullptr, param, path, devPath, prefix, root, nullptr)
+{
+    _manager = std::make_unique<sdbusplus::server::manager::manager>(
+            _bus, root);
+    _statsManager = std::make_unique<sdbusplus::server::manager::manager>(
+            _bus, stats_root);
+}
+
+MainLoop::MainLoop(
+    sdbusplus::bus::bus& bus,
+    const std::string& param,
+    const std::string& path,
+    const std::string& devPath,
+    const char* prefix,
+    const char* root,
+    env::Settings settings)
+    : MainLoop(nullptr,
+               &bus,
+               param,
+               path,
+               devPath,
+               prefix,
+               root,
+               std::make_unique<env::Settings>(std::move(settings)))
+{
+}
+
+MainLoop::MainLoop(
+    std::unique_ptr<sdbusplus::bus::bus> ownBus,
+    sdbusplus::bus::bus* sharedBus,
+    const std::string& param,
+    const std::string& path,
+    const std::string& devPath,
+    const char* prefix,
+    const char* root,
+    std::unique_ptr<env::Settings> settings)
+    : _ownBus(std::move(ownBus)),
+      _bus(sharedBus ? *sharedBus : *_ownBus),
       _pathParam(param),
       _hwmonRoot(),
       _instance(),
       _devPath(devPath),
       _prefix(prefix),
       _root(root),
+      _settings(std::move(settings)),
       state(),
-      ioAccess(path)
+      signals(_bus),
+#ifdef HAVE_LIBURING
+      ioAccess(std::make_unique<hwmonio::HwmonIOUring>(path))
+#else
+      ioAccess(std::make_unique<hwmonio::HwmonIO>(path))
+#endif
 {
     // Strip off any trailing slashes.
     std::string p = path;
@@ -284,6 +650,19 @@ MainLoop::MainLoop(
     assert(!_hwmonRoot.empty());
 }
 
+MainLoop::~MainLoop()
+{
+    // A device stopped mid-batch still has reads copying into the batch
+    // buffers, which are destroyed before the pool would be.
+    pool.reset();
+
+    // Another device or a restarted daemon may take the name over.
+    if (!_busName.empty())
+    {
+        sd_bus_release_name(_bus.get(), _busName.c_str());
+    }
+}
+
 void MainLoop::shutdown() noexcept
 {
     timer->state(phosphor::hwmon::timer::OFF);
@@ -291,28 +670,137 @@ void MainLoop::shutdown() noexcept
     loop = nullptr;
 }
 
-void MainLoop::run()
+void MainLoop::gone()
+{
+    // There are race conditions between the unloading of a hwmon
+    // driver and the stopping of this service by systemd, so this
+    // isn't a failure.  See HwmonIO::read.
+    log<level::INFO>("Device is gone, stopping",
+                     entry("PATH=%s", _devPath.c_str()));
+
+    stop(0);
+}
+
+void MainLoop::stop(int status)
 {
-    init();
+    if (exitStatus)
+    {
+        return;
+    }
+    exitStatus = status;
+
+    if (timer)
+    {
+        timer->state(phosphor::hwmon::timer::OFF);
+    }
+    if (snapshotTimer)
+    {
+        snapshotTimer->state(phosphor::hwmon::timer::OFF);
+    }
+    for (auto& r : retryQueue)
+    {
+        if (r.second.timer)
+        {
+            r.second.timer->state(phosphor::hwmon::timer::OFF);
+        }
+    }
+
+    if (_stopped)
+    {
+        _stopped();
+    }
+}
 
+int MainLoop::run()
+{
     sd_event_default(&loop);
 
+    // Block SIGHUP before the read threads start, so only the
+    // event loop sees it.
+    sigset_t hangup;
+    sigemptyset(&hangup);
+    sigaddset(&hangup, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &hangup, nullptr);
+
+    auto stopped = [this]()
+    {
+        sd_event_exit(loop, status());
+    };
+    if (!start(loop, stopped))
+    {
+        return status();
+    }
+
+    sd_event_add_signal(
+            loop, nullptr, SIGHUP,
+            [](sd_event_source*, const struct signalfd_siginfo*, void* data)
+            {
+                static_cast<MainLoop*>(data)->reload();
+                return 0;
+            },
+            this);
+
+    try
+    {
+        _bus.attach_event(loop, SD_EVENT_PRIORITY_IMPORTANT);
+        sd_event_loop(loop);
+    }
+    catch (const std::system_error& e)
+    {
+        log<level::ERR>("Error in sysfs polling loop",
+                        entry("ERROR=%s", e.what()));
+        throw;
+    }
+
+    return status();
+}
+
+bool MainLoop::start(sd_event* event, std::function<void()> stopped)
+{
+    env::Scope scope(_settings.get());
+
+    loop = event;
+    _stopped = std::move(stopped);
+
+    if (!init())
+    {
+        return false;
+    }
+
     std::function<void()> callback(std::bind(
             &MainLoop::read, this));
     try
     {
+        if (_readThreads)
+        {
+            pool = std::make_unique<phosphor::hwmon::ReadPool>(
+                    loop, *ioAccess, _readThreads,
+                    std::bind(&MainLoop::complete, this));
+        }
+
         timer = std::make_unique<phosphor::hwmon::Timer>(
                                  loop, callback,
-                                 std::chrono::microseconds(_interval),
+                                 std::chrono::microseconds(_tick),
                                  phosphor::hwmon::timer::ON);
+        timer->fixedRate();
 
-        // TODO: Issue#6 - Optionally look at polling interval sysfs entry.
+        hotplug = std::make_unique<phosphor::hwmon::HotPlug>(
+                loop, _hwmonRoot + '/' + _instance,
+                std::bind(&MainLoop::rescan, this));
 
-        // TODO: Issue#7 - Should probably periodically check the SensorSet
-        //       for new entries.
+        auto snapshotInterval = _config.snapshotInterval;
+        if (snapshotInterval)
+        {
+            std::error_code ec;
+            std::experimental::filesystem::create_directories(
+                    snapshot_dir, ec);
 
-        _bus.attach_event(loop, SD_EVENT_PRIORITY_IMPORTANT);
-        sd_event_loop(loop);
+            snapshotTimer = std::make_unique<phosphor::hwmon::Timer>(
+                    loop,
+                    std::bind(&MainLoop::saveSnapshot, this),
+                    std::chrono::microseconds(snapshotInterval),
+                    phosphor::hwmon::timer::ON);
+        }
     }
     catch (const std::system_error& e)
     {
@@ -320,18 +808,67 @@ void MainLoop::run()
                         entry("ERROR=%s", e.what()));
         throw;
     }
+
+    return true;
 }
 
-void MainLoop::init()
+bool MainLoop::init()
 {
+    // Parse the settings once, everything below reads them from here.
+    _config = config::load();
+
+    auto id = std::to_string(
+            std::hash<std::string>{}(_devPath + _pathParam));
+    _snapshotPath = std::string(snapshot_dir) + '/' + id;
+    openTable();
+
+    // Publish the sensors in a recent restart snapshot with their last
+    // values instead of reading them, the first polls refresh them.
+    std::map<SensorSet::key_type, phosphor::hwmon::snapshot::Entry> restored;
+    if (_config.snapshotInterval)
+    {
+        std::chrono::microseconds maxAge(
+                _config.snapshotMaxAge.value_or(default_snapshot_max_age));
+        for (auto& e : phosphor::hwmon::snapshot::load(_snapshotPath, maxAge))
+        {
+            auto key = std::make_pair(e.type, e.id);
+            restored.emplace(std::move(key), std::move(e));
+        }
+    }
+
     // Check sysfs for available sensors.
     auto sensors = std::make_unique<SensorSet>(_hwmonRoot + '/' + _instance);
 
+    // Read the rest concurrently, their objects are then created from
+    // the readings on this thread.
+    auto prefetched = prefetch(*sensors, restored);
+
     for (auto& i : *sensors)
     {
-        auto object = getObject(i);
+        const phosphor::hwmon::snapshot::Entry* entry = nullptr;
+        auto r = restored.find(i.first);
+        if (r != restored.end() &&
+            SensorSet::mapped_type(r->second.attributes.begin(),
+                                   r->second.attributes.end()) == i.second)
+        {
+            entry = &r->second;
+        }
+
+        auto p = prefetched.find(i.first);
+        auto object = getObject(
+                i, entry, (p != prefetched.end()) ? &p->second : nullptr);
+        if (stopped())
+        {
+            break;
+        }
         if (object)
         {
+            if (entry &&
+                std::get<std::string>((*object).second) == entry->path)
+            {
+                stale.insert(i.first);
+            }
+
             // Construct the SensorSet value
             // std::tuple<SensorSet::mapped_type,
             //            std::string(Sensor Label),
@@ -344,158 +881,1361 @@ void MainLoop::init()
         }
     }
 
-    /* If there are no sensors specified by labels, exit. */
-    if (0 == state.size())
+    /* If there are no sensors specified by labels, stop. */
+    if (0 == state.size() || stopped())
     {
-        exit(0);
+        return false;
     }
 
+    _alarmEvents = _config.alarmEvents;
+
+    configureInterval();
+
+    buildBatch();
+
     {
+        stats = std::make_unique<phosphor::hwmon::PollStatistics>(
+                _bus, std::string(stats_root) + '/' + id);
+        stats->stale(stale.size());
+
         std::stringstream ss;
         ss << _prefix
            << "-"
-           << std::to_string(std::hash<std::string>{}(_devPath + _pathParam))
+           << id
            << ".Hwmon1";
 
         _bus.request_name(ss.str().c_str());
+        _busName = ss.str();
     }
 
+    signals.defer(_config.coalesceSignals);
+
+    _readThreads = _config.readThreads;
+
+    return true;
+}
+
+void MainLoop::rescan()
+{
+    if (stopped())
     {
-        auto interval = env::getEnv("INTERVAL");
-        if (!interval.empty())
-        {
-            _interval = std::strtoull(interval.c_str(), NULL, 10);
-        }
+        return;
+    }
+
+    if (pool && pool->busy())
+    {
+        // The pool may be using the sensor state, try again once it's done.
+        hotplug->schedule();
+        return;
+    }
+
+    if (resync())
+    {
+        buildBatch();
     }
 }
 
-void MainLoop::read()
+bool MainLoop::resync()
 {
-    // TODO: Issue#3 - Need to make calls to the dbus sensor cache here to
-    //       ensure the objects all exist?
+    std::unique_ptr<SensorSet> sensors;
+    try
+    {
+        sensors = std::make_unique<SensorSet>(_hwmonRoot + '/' + _instance);
+    }
+    catch (const std::exception& e)
+    {
+        // The device is going away, the next read will notice.
+        return false;
+    }
 
-    // Iterate through all the sensors.
-    for (auto& i : state)
+    auto changed = false;
+
+    // Remove the sensors that are gone or whose attributes changed.
+    auto i = state.begin();
+    while (i != state.end())
     {
-        auto& attrs = std::get<0>(i.second);
-        if (attrs.find(hwmon::entry::input) != attrs.end())
+        auto sensor = sensors->find(i->first);
+        if (sensor != sensors->end() &&
+            sensor->second == std::get<0>(i->second))
         {
-            // Read value from sensor.
-            int64_t value;
-            std::string input = hwmon::entry::cinput;
-            if (i.first.first == "pwm") {
-                input = "";
-            }
-
-            try
-            {
-                auto& objInfo = std::get<ObjectInfo>(i.second);
-                auto& obj = std::get<Object>(objInfo);
+            ++i;
+            continue;
+        }
 
-                auto it = obj.find(InterfaceType::STATUS);
-                if (it != obj.end())
-                {
-                    auto fault = ioAccess.read(
-                            i.first.first,
-                            i.first.second,
-                            hwmon::entry::fault,
-                            hwmonio::retries,
-                            hwmonio::delay);
-                    auto statusIface = std::experimental::any_cast<
-                            std::shared_ptr<StatusObject>>(it->second);
-                    if (!statusIface->functional((fault == 0) ? true : false))
-                    {
-                        continue;
-                    }
-                }
-
-                // Retry for up to a second if device is busy
-                // or has a transient error.
-
-                value = ioAccess.read(
-                        i.first.first,
-                        i.first.second,
-                        input,
-                        hwmonio::retries,
-                        hwmonio::delay);
+        log<level::INFO>("Removing sensor after hot-plug change",
+                entry("TYPE=%s", i->first.first.c_str()),
+                entry("ID=%s", i->first.second.c_str()));
+        sensorObjects.erase(i->first);
+        chipAlarms.erase(i->first);
+        histories.erase(i->first);
+        i = state.erase(i);
+        changed = true;
+    }
 
-                value = sensorObjects[i.first]->adjustValue(value);
+    // Forget removed sensors that are gone, the rest are re-added
+    // when they can be read again.
+    auto rm = rmSensors.begin();
+    while (rm != rmSensors.end())
+    {
+        if (sensors->find(rm->first) == sensors->end())
+        {
+            rm = rmSensors.erase(rm);
+        }
+        else
+        {
+            ++rm;
+        }
+    }
 
-                for (auto& iface : obj)
-                {
-                    auto valueIface = std::shared_ptr<ValueObject>();
-                    auto warnIface = std::shared_ptr<WarningObject>();
-                    auto critIface = std::shared_ptr<CriticalObject>();
-
-                    switch (iface.first)
-                    {
-                        case InterfaceType::VALUE:
-                            valueIface = std::experimental::any_cast<std::shared_ptr<ValueObject>>
-                                        (iface.second);
-                            valueIface->value(value);
-                            break;
-                        case InterfaceType::WARN:
-                            checkThresholds<WarningObject>(iface.second, value);
-                            break;
-                        case InterfaceType::CRIT:
-                            checkThresholds<CriticalObject>(iface.second, value);
-                            break;
-                        default:
-                            break;
-                    }
-                }
+    // Add the new sensors.
+    for (auto& sensor : *sensors)
+    {
+        if (state.find(sensor.first) != state.end() ||
+            rmSensors.find(sensor.first) != rmSensors.end())
+        {
+            continue;
+        }
+
+        auto object = getObject(sensor);
+        if (object)
+        {
+            log<level::INFO>("Added sensor after hot-plug change",
+                    entry("TYPE=%s", sensor.first.first.c_str()),
+                    entry("ID=%s", sensor.first.second.c_str()));
+
+            auto value = std::make_tuple(sensor.second,
+                                         std::move((*object).first),
+                                         std::move((*object).second));
+
+            state[sensor.first] = std::move(value);
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+void MainLoop::configureInterval()
+{
+    _interval = default_interval;
+
+    // An explicit INTERVAL takes precedence over the driver's.
+    alignInterval();
+
+    if (_config.interval)
+    {
+        _interval = *_config.interval;
+    }
+}
+
+void MainLoop::reload()
+{
+    if (stopped())
+    {
+        return;
+    }
+
+    if (pool && pool->busy())
+    {
+        // The pool may be using the polled sensors, reload once it's done.
+        reloadPending = true;
+        return;
+    }
+    reloadPending = false;
+
+    env::Scope scope(_settings.get());
+    auto next = config::load();
+
+    auto interval = next.interval != _config.interval ||
+                    next.updateInterval != _config.updateInterval;
+    auto retune = interval ||
+                  next.deadband != _config.deadband ||
+                  next.heartbeat != _config.heartbeat ||
+                  next.debounce != _config.debounce ||
+                  next.alarmEvents != _config.alarmEvents;
+    auto retarget = next.targetMode != _config.targetMode;
+    auto rechip = next.chipThresholds != _config.chipThresholds;
+    auto retable = next.sensorTable != _config.sensorTable;
+
+    auto i = state.begin();
+    while (i != state.end())
+    {
+        const auto& key = i->first;
+        const auto& from = _config.sensor(key);
+        const auto& to = next.sensor(key);
+
+        // Limits read from the chip are adjusted when they're read.
+        auto recreate = reshaped(from, to) ||
+            (retarget && (key.first == "fan" || key.first == "pwm")) ||
+            rechip ||
+            (chipAlarms.count(key) &&
+             (from.gain != to.gain || from.offset != to.offset));
+        if (!recreate)
+        {
+            SensorSet::container_t::value_type sensor{
+                key, std::get<0>(i->second)};
+            auto id = getID(sensor);
+            const auto& fromId = _config.sensor(key.first, id);
+            const auto& toId = next.sensor(key.first, id);
+
+            recreate = relabeled(fromId, toId);
+            if (!recreate)
+            {
+                auto& obj = std::get<Object>(std::get<ObjectInfo>(i->second));
+                setThresholds(
+                        getInterface<WarningObject>(obj, InterfaceType::WARN),
+                        toId);
+                setThresholds(
+                        getInterface<CriticalObject>(obj, InterfaceType::CRIT),
+                        toId);
+            }
+        }
+
+        if (recreate)
+        {
+            // Added back with the new settings by resync().
+            log<level::INFO>("Recreating sensor for its new settings",
+                    entry("TYPE=%s", key.first.c_str()),
+                    entry("ID=%s", key.second.c_str()));
+            sensorObjects.erase(key);
+            chipAlarms.erase(key);
+            histories.erase(key);
+            i = state.erase(i);
+
+            // The polled records are rebuilt below, it gets a new one.
+            retune = true;
+            continue;
+        }
+
+        auto& object = sensorObjects[key];
+        object->reconfigure(to);
+        object->addRemoveRCs(next.removeRCs);
+
+        // A new size or windows starts the history over.
+        auto size = historySize(next, key);
+        if (size != historySize(_config, key) ||
+            (size && next.statWindows != _config.statWindows))
+        {
+            addHistory(key,
+                       std::get<std::string>(std::get<ObjectInfo>(i->second)),
+                       next, true);
+            retune = true;
+        }
+
+        retune |= from.interval != to.interval ||
+                  from.deadband != to.deadband ||
+                  from.debounce != to.debounce ||
+                  from.warnHyst != to.warnHyst ||
+                  from.critHyst != to.critHyst ||
+                  from.heartbeat != to.heartbeat;
+        ++i;
+    }
+
+    _config = std::move(next);
+    _alarmEvents = _config.alarmEvents;
+    signals.defer(_config.coalesceSignals);
+
+    if (retable)
+    {
+        // The polled sensors' records are looked up again below.
+        openTable();
+        retune = true;
+    }
+
+    if (interval)
+    {
+        configureInterval();
+    }
+
+    if (resync() || retune)
+    {
+        buildBatch();
+    }
+
+    log<level::INFO>("Reloaded settings",
+            entry("PATH=%s", _pathParam.c_str()));
+}
+
+uint8_t MainLoop::chipThresholds(
+        SensorSet::container_t::const_reference sensor,
+        sensor::Sensor& object,
+        config::Sensor& thresholds,
+        uint8_t& limited)
+{
+    // By alarm bit, like limitAttributes.
+    config::optional<int64_t>* limits[] =
+    {
+        &thresholds.warnLo,
+        &thresholds.warnHi,
+        &thresholds.critLo,
+        &thresholds.critHi,
+    };
+    auto& attrs = sensor.second;
+    uint8_t chip = 0;
+
+    for (size_t kind = 0; kind < 4; kind += 2)
+    {
+        auto& lo = *limits[kind];
+        auto& hi = *limits[kind + 1];
+        if (lo || hi)
+        {
+            continue;
+        }
+
+        for (auto n = kind; n < kind + 2; ++n)
+        {
+            if (attrs.find(limitAttributes[n]) == attrs.end())
+            {
+                continue;
+            }
+
+            try
+            {
+                // Limits are read once, only the alarms are polled.
+                auto limit = ioAccess->read(
+                        sensor.first.first,
+                        sensor.first.second,
+                        limitAttributes[n],
+                        hwmonio::retries,
+                        hwmonio::delay);
+                *limits[n] = object.adjustValue(limit);
+                limited |= 1 << n;
             }
             catch (const std::system_error& e)
             {
-                auto file = sysfs::make_sysfs_path(
-                        ioAccess.path(),
-                        i.first.first,
-                        i.first.second,
-                        hwmon::entry::cinput);
-#ifndef REMOVE_ON_FAIL
-                // Check sensorAdjusts for sensor removal RCs
-                auto& sAdjusts = sensorObjects[i.first]->getAdjusts();
-                if (sAdjusts.rmRCs.count(e.code().value()) > 0)
+                log<level::INFO>("Unable to read chip threshold",
+                        entry("TYPE=%s", sensor.first.first.c_str()),
+                        entry("ID=%s", sensor.first.second.c_str()),
+                        entry("LIMIT=%s", limitAttributes[n]));
+                continue;
+            }
+
+            if (attrs.find(alarmAttributes[n]) != attrs.end())
+            {
+                chip |= 1 << n;
+            }
+        }
+
+        if (lo || hi)
+        {
+            if (!lo)
+            {
+                lo = std::numeric_limits<int64_t>::min();
+            }
+            if (!hi)
+            {
+                hi = std::numeric_limits<int64_t>::max();
+            }
+        }
+    }
+
+    return chip;
+}
+
+std::map<SensorSet::key_type, MainLoop::Prefetch> MainLoop::prefetch(
+        SensorSet& sensors,
+        const std::map<SensorSet::key_type,
+                       phosphor::hwmon::snapshot::Entry>& skip)
+{
+    std::map<SensorSet::key_type, Prefetch> prefetched;
+    std::vector<hwmonio::HwmonIO::Attribute> attributes;
+    // The sensor and whether it's the fault reading, of each attribute.
+    std::vector<std::pair<Prefetch*, bool>> readings;
+
+    for (auto& i : sensors)
+    {
+        hwmon::Attributes attrs;
+        if (skip.find(i.first) != skip.end() ||
+            !hwmon::getAttributes(i.first.first, attrs))
+        {
+            continue;
+        }
+
+        // Only the sensors getObject() creates objects for.
+        auto properties = getIdentifiers(i);
+        if (std::get<sensorID>(properties).empty() ||
+            std::get<sensorLabel>(properties).empty())
+        {
+            continue;
+        }
+
+        auto& p = prefetched[i.first];
+        if (i.second.find(hwmon::entry::fault) != i.second.end())
+        {
+            attributes.push_back(ioAccess->attribute(
+                    i.first.first, i.first.second, hwmon::entry::fault));
+            readings.emplace_back(&p, true);
+        }
+        attributes.push_back(ioAccess->attribute(
+                i.first.first, i.first.second, hwmon::entry::cinput));
+        readings.emplace_back(&p, false);
+    }
+
+    if (attributes.empty())
+    {
+        return prefetched;
+    }
+
+    std::vector<int64_t> values;
+    std::vector<int> errors;
+    auto threads = _config.readThreads ?
+        _config.readThreads : default_init_threads;
+    phosphor::hwmon::ReadPool::readAll(
+            *ioAccess, threads, attributes, values, errors);
+
+    for (size_t i = 0; i < readings.size(); ++i)
+    {
+        auto reading = std::make_pair(errors[i], values[i]);
+        if (readings[i].second)
+        {
+            readings[i].first->fault = reading;
+        }
+        else
+        {
+            readings[i].first->input = reading;
+        }
+    }
+
+    return prefetched;
+}
+
+void MainLoop::addHistory(const SensorSet::key_type& sensor,
+                          const std::string& path,
+                          const config::Device& config,
+                          bool announce)
+{
+    // Only one history interface can be registered on the path.
+    histories.erase(sensor);
+
+    auto size = historySize(config, sensor);
+    if (size)
+    {
+        histories[sensor] = std::make_unique<phosphor::hwmon::SensorHistory>(
+                _bus, path, size, config.statWindows, announce);
+    }
+}
+
+void MainLoop::openTable()
+{
+    // Records are only read from polled sensors.
+    for (auto& p : polled)
+    {
+        p.slot = phosphor::hwmon::SensorTable::npos;
+    }
+    sensorTable.reset();
+
+    if (!_config.sensorTable)
+    {
+        return;
+    }
+
+    auto path = _snapshotPath + ".table";
+    try
+    {
+        sensorTable = std::make_unique<phosphor::hwmon::SensorTable>(path);
+    }
+    catch (const std::system_error& e)
+    {
+        log<level::ERR>("Unable to open the sensor table",
+                entry("PATH=%s", path.c_str()),
+                entry("ERROR=%s", e.what()));
+    }
+}
+
+void MainLoop::tabulate(const Polled& p, bool read)
+{
+    namespace table = phosphor::hwmon::table;
+
+    if (!sensorTable || p.slot == phosphor::hwmon::SensorTable::npos)
+    {
+        return;
+    }
+
+    uint32_t status = 0;
+    if (!p.status || p.status->functional())
+    {
+        status |= table::FUNCTIONAL;
+    }
+    if (stale.count(p.sensor->first))
+    {
+        status |= table::STALE;
+    }
+
+    uint32_t alarms = 0;
+    if (p.warn)
+    {
+        alarms |= p.warn->warningAlarmLow() ? table::WARN_LO : 0;
+        alarms |= p.warn->warningAlarmHigh() ? table::WARN_HI : 0;
+    }
+    if (p.crit)
+    {
+        alarms |= p.crit->criticalAlarmLow() ? table::CRIT_LO : 0;
+        alarms |= p.crit->criticalAlarmHigh() ? table::CRIT_HI : 0;
+    }
+
+    sensorTable->begin();
+    sensorTable->update(p.slot, p.reading, status, alarms);
+    if (read)
+    {
+        auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch());
+        sensorTable->stamp(p.slot, now.count());
+    }
+    sensorTable->end();
+}
+
+void MainLoop::saveSnapshot()
+{
+    namespace snapshot = phosphor::hwmon::snapshot;
+
+    // Values restored from the last snapshot are no newer than it.
+    if (!stale.empty())
+    {
+        return;
+    }
+
+    std::vector<snapshot::Entry> entries;
+    entries.reserve(state.size());
+    for (auto& i : state)
+    {
+        auto& info = std::get<ObjectInfo>(i.second);
+        auto& obj = std::get<Object>(info);
+        auto value = getInterface<ValueObject>(obj, InterfaceType::VALUE);
+        if (!value)
+        {
+            continue;
+        }
+
+        snapshot::Entry e;
+        e.type = i.first.first;
+        e.id = i.first.second;
+        e.attributes.assign(std::get<0>(i.second).begin(),
+                            std::get<0>(i.second).end());
+        e.path = std::get<std::string>(info);
+        e.value = value->value();
+        auto status = getInterface<StatusObject>(obj, InterfaceType::STATUS);
+        e.functional = !status || status->functional();
+        entries.push_back(std::move(e));
+    }
+
+    if (!snapshot::save(_snapshotPath, entries))
+    {
+        log<level::DEBUG>("Unable to save the restart snapshot",
+                entry("FILE=%s", _snapshotPath.c_str()));
+    }
+}
+
+void MainLoop::refreshed(const SensorSet::key_type& sensor)
+{
+    if (!stale.empty() && stale.erase(sensor))
+    {
+        stats->stale(stale.size());
+    }
+}
+
+void MainLoop::alignInterval()
+{
+    auto path = _hwmonRoot + '/' + _instance + "/update_interval";
+
+    if (_config.updateInterval)
+    {
+        auto requested = *_config.updateInterval;
+        std::ofstream ofs(path);
+        ofs << requested << std::flush;
+        if (ofs.fail())
+        {
+            log<level::INFO>("Unable to set update_interval",
+                    entry("FILE=%s", path.c_str()),
+                    entry("INTERVAL=%llu",
+                          static_cast<unsigned long long>(requested)));
+        }
+    }
+
+    // The driver may have rounded the requested interval.
+    std::ifstream ifs(path);
+    uint64_t ms = 0;
+    if (!(ifs >> ms) || !ms)
+    {
+        return;
+    }
+
+    // Drivers that cache refresh on the first read after the interval
+    // has passed, so read a little after it or a read that's a little
+    // early gets the old data, and the refresh waits another interval.
+    auto usec = ms * 1000;
+    _interval = usec + std::max<uint64_t>(update_margin, usec / 50);
+
+    log<level::INFO>("Polling at the driver update_interval",
+            entry("FILE=%s", path.c_str()),
+            entry("INTERVAL=%llu", static_cast<unsigned long long>(_interval)));
+}
+
+void MainLoop::buildBatch()
+{
+    // Sensors removed before they were read again aren't stale.
+    for (auto s = stale.begin(); s != stale.end();)
+    {
+        s = (state.find(*s) == state.end()) ? stale.erase(s) : std::next(s);
+    }
+    if (stats)
+    {
+        stats->stale(stale.size());
+    }
+
+    // Sensors still polled with the same objects carry their state
+    // over from their previous records, in the same key order.
+    notifiers.clear();
+    std::vector<Polled> previous;
+    previous.swap(polled);
+    std::vector<uint64_t> delays(previous.size());
+    wheel.remaining(delays);
+    std::vector<size_t> carried;
+    auto last = [this, &previous](const SensorSet::key_type& key)
+    {
+        auto p = std::lower_bound(
+                previous.begin(), previous.end(), key,
+                [](const Polled& p, const SensorSet::key_type& key)
                 {
-                    // Return code found in sensor return code removal list
-                    if (rmSensors.find(i.first) == rmSensors.end())
-                    {
-                        // Trace for sensor not already removed from dbus
-                        log<level::INFO>(
-                                "Remove sensor from dbus for read fail",
-                                entry("FILE=%s", file.c_str()),
-                                entry("RC=%d", e.code().value()));
-                        // Mark this sensor to be removed from dbus
-                        rmSensors[i.first] = std::get<0>(i.second);
-                    }
-                    continue;
-                }
+                    return p.key < key;
+                });
+        if (p == previous.end() || p->key != key || created.count(key))
+        {
+            return previous.size();
+        }
+        return static_cast<size_t>(p - previous.begin());
+    };
+
+    for (auto i = state.begin(); i != state.end(); ++i)
+    {
+        auto& attrs = std::get<0>(i->second);
+        if (attrs.find(hwmon::entry::input) == attrs.end())
+        {
+            continue;
+        }
+
+        auto& sensorConfig = _config.sensor(i->first);
+
+        Polled poll;
+        poll.sensor = i;
+        poll.key = i->first;
+        poll.interval = _interval;
+
+        if (sensorConfig.interval)
+        {
+            poll.interval = *sensorConfig.interval;
+        }
+        if (!poll.interval)
+        {
+            poll.interval = _interval;
+        }
+
+        poll.object = sensorObjects[i->first].get();
+        poll.path = &std::get<std::string>(std::get<ObjectInfo>(i->second));
+
+        auto& obj = std::get<Object>(std::get<ObjectInfo>(i->second));
+        poll.value = getInterface<ValueObject>(obj, InterfaceType::VALUE);
+        poll.warn = getInterface<WarningObject>(obj, InterfaceType::WARN);
+        poll.crit = getInterface<CriticalObject>(obj, InterfaceType::CRIT);
+        poll.status = getInterface<StatusObject>(obj, InterfaceType::STATUS);
+        auto history = histories.find(i->first);
+        if (history != histories.end())
+        {
+            poll.history = history->second.get();
+        }
+        if (poll.value)
+        {
+            poll.reading = poll.value->value();
+        }
+
+        auto chip = chipAlarms.find(i->first);
+        if (chip != chipAlarms.end())
+        {
+            poll.chip = chip->second;
+        }
+
+        auto prev = last(i->first);
+        carried.push_back(prev);
+
+        auto debounce = sensorConfig.debounce ?
+            sensorConfig.debounce : _config.debounce;
+        if (poll.warn)
+        {
+            resetThresholds(*poll.warn, poll.warnFilter, sensorConfig,
+                            debounce.value_or(hwmon::Debounce()));
+        }
+        if (poll.crit)
+        {
+            resetThresholds(*poll.crit, poll.critFilter, sensorConfig,
+                            debounce.value_or(hwmon::Debounce()));
+        }
+        if (prev < previous.size())
+        {
+            // Pending debounce samples are kept, unless the samples or
+            // the hysteresis they were taken with changed.
+            keepFilter(poll.warnFilter, previous[prev].warnFilter);
+            keepFilter(poll.critFilter, previous[prev].critFilter);
+        }
+
+        auto deadband = sensorConfig.deadband ?
+            sensorConfig.deadband : _config.deadband;
+        auto heartbeat = sensorConfig.heartbeat ?
+            sensorConfig.heartbeat : _config.heartbeat;
+        if (poll.value && (deadband || heartbeat))
+        {
+            poll.filtered = true;
+            poll.deadband = deadband.value_or(hwmon::Deadband());
+            poll.heartbeat = std::chrono::microseconds(heartbeat.value_or(0));
+            poll.published = poll.value->value();
+            poll.lastPublished = std::chrono::steady_clock::now();
+
+            // The deadband stays around the value last published, and
+            // the heartbeat runs on from when it was.
+            if (prev < previous.size() && previous[prev].filtered)
+            {
+                poll.published = previous[prev].published;
+                poll.lastPublished = previous[prev].lastPublished;
+            }
+        }
+        if (poll.value && prev < previous.size())
+        {
+            poll.reading = previous[prev].reading;
+        }
+
+        if (poll.status)
+        {
+            poll.fault = ioAccess->attribute(
+                    i->first.first,
+                    i->first.second,
+                    hwmon::entry::fault);
+        }
+
+        std::string input = hwmon::entry::cinput;
+        if (i->first.first == "pwm") {
+            input = "";
+        }
+
+        poll.input = ioAccess->attribute(
+                i->first.first,
+                i->first.second,
+                input);
+
+        polled.push_back(std::move(poll));
+    }
+
+    if (sensorTable)
+    {
+        // Sensors that are gone keep their records, not PRESENT.
+        sensorTable->begin();
+        sensorTable->clear();
+        for (auto& p : polled)
+        {
+            const auto& key = p.sensor->first;
+            p.slot = sensorTable->add(key.first + key.second, *p.path);
+            if (p.slot == phosphor::hwmon::SensorTable::npos)
+            {
+                log<level::ERR>("No room for the sensor in the sensor table",
+                        entry("TYPE=%s", key.first.c_str()),
+                        entry("ID=%s", key.second.c_str()));
+                continue;
+            }
+            tabulate(p, false);
+        }
+        sensorTable->end();
+    }
+
+    for (size_t i = 0; i < polled.size(); ++i)
+    {
+        auto& p = polled[i];
+
+        // Only the alarms of limits read from the chip are the chip's,
+        // the others compare the value against our own limits.  They're
+        // watched, or read with the input if they can't be.
+        for (size_t n = 0; n < 4; ++n)
+        {
+            auto alarm = static_cast<Alarm>(1 << n);
+            if (!(p.chip & alarm) ||
+                (_alarmEvents && watchAlarm(i, alarm, alarmAttributes[n])))
+            {
+                continue;
+            }
+            p.alarmInputs[n] = ioAccess->attribute(
+                    p.sensor->first.first,
+                    p.sensor->first.second,
+                    alarmAttributes[n]);
+            p.polledAlarms |= alarm;
+        }
+        if (_alarmEvents && p.status)
+        {
+            watchAlarm(i, FAULT, hwmon::entry::cfault);
+        }
+    }
+
+    // Tick at the greatest common divisor of the intervals, but not so
+    // fast the loop spends its time waking up for nothing.  Intervals
+    // are rounded to the nearest whole tick.
+    uint64_t tick = 0;
+    uint64_t shortest = _interval;
+    for (auto& p : polled)
+    {
+        tick = gcd(p.interval, tick);
+        shortest = std::min(shortest, p.interval);
+    }
+    tick = std::max<uint64_t>(
+            tick,
+            std::min<uint64_t>(min_tick, shortest));
+
+    // Sensors still polled at the same interval keep their place in
+    // the schedule, rather than all being read on the next tick.
+    wheel.clear();
+    for (size_t i = 0; i < polled.size(); ++i)
+    {
+        auto ticks = (polled[i].interval + tick / 2) / tick;
+
+        // New sensors and new intervals are read on the next tick.
+        uint64_t delay = 1;
+        auto prev = carried[i];
+        if (prev < previous.size() &&
+            previous[prev].interval == polled[i].interval)
+        {
+            delay = (delays[prev] * _tick + tick - 1) / tick;
+        }
+        wheel.add(i, std::max<uint64_t>(ticks, 1), delay);
+    }
+    created.clear();
+
+    if (tick != _tick)
+    {
+        _tick = tick;
+        if (timer)
+        {
+            timer->start(
+                    std::chrono::microseconds(_tick),
+                    phosphor::hwmon::timer::ON);
+        }
+    }
+}
+
+bool MainLoop::watchAlarm(size_t sensor, Alarm alarm, const char* attribute)
+{
+    auto& p = polled[sensor];
+    auto path = sysfs::make_sysfs_path(
+            ioAccess->path(),
+            p.sensor->first.first,
+            p.sensor->first.second,
+            attribute);
+
+    try
+    {
+        auto notify = std::make_unique<phosphor::hwmon::Notify>(
+                loop, path,
+                std::bind(&MainLoop::alarm, this, sensor, alarm,
+                          std::placeholders::_1));
+        if (notify->initial())
+        {
+            p.alarms |= alarm;
+        }
+        notifiers.push_back(std::move(notify));
+    }
+    catch (const std::system_error& e)
+    {
+        // Not every chip has every attribute, and the poll loop still
+        // reads the fault attribute of those that don't.
+        return false;
+    }
+
+    return true;
+}
+
+void MainLoop::alarm(size_t sensor, Alarm alarm, int64_t value)
+{
+    static constexpr auto skipSignal = true;
+    if (stopped())
+    {
+        return;
+    }
+
+    auto& p = polled[sensor];
+
+    if (value)
+    {
+        p.alarms |= alarm;
+    }
+    else
+    {
+        p.alarms &= ~alarm;
+    }
+
+    if (alarm == FAULT)
+    {
+        auto functional = (value == 0);
+        if (p.status->functional() != functional)
+        {
+            p.status->functional(functional, skipSignal);
+            signals.changed(*p.path, statusIfaceName, "Functional");
+        }
+    }
+    else if (p.value)
+    {
+        // Evaluate against the last reading, with the new alarm.
+        auto last = p.reading;
+        if (p.warn)
+        {
+            checkThresholds(*p.warn, last, p.hardware(WARN_LO, WARN_HI),
+                            p.fromChip(WARN_LO, WARN_HI), p.warnFilter,
+                            signals, *p.path);
+        }
+        if (p.crit)
+        {
+            checkThresholds(*p.crit, last, p.hardware(CRIT_LO, CRIT_HI),
+                            p.fromChip(CRIT_LO, CRIT_HI), p.critFilter,
+                            signals, *p.path);
+        }
+    }
+
+    tabulate(p, false);
+    signals.flush();
+}
+
+void MainLoop::thresholdsChanged(const SensorSet::key_type& sensor,
+                                 InterfaceType type,
+                                 bool high)
+{
+    // The polled sensors are in the same order as the sensor state.
+    // A reload sets thresholds after recreated sensors' state is gone,
+    // so the records are found by their own keys.
+    auto p = std::lower_bound(
+            polled.begin(), polled.end(), sensor,
+            [](const Polled& p, const SensorSet::key_type& key)
+            {
+                return p.key < key;
+            });
+    if (p == polled.end() || p->key != sensor)
+    {
+        return;
+    }
+
+    // Evaluate the last reading against the new limit, without waiting
+    // for the debounce.
+    if (type == InterfaceType::WARN && p->warn)
+    {
+        rebaseThresholds(*p->warn, p->warnFilter, p->reading, high);
+        checkThresholds(*p->warn, p->reading, p->hardware(WARN_LO, WARN_HI),
+                        p->fromChip(WARN_LO, WARN_HI), p->warnFilter,
+                        signals, *p->path);
+    }
+    if (type == InterfaceType::CRIT && p->crit)
+    {
+        rebaseThresholds(*p->crit, p->critFilter, p->reading, high);
+        checkThresholds(*p->crit, p->reading, p->hardware(CRIT_LO, CRIT_HI),
+                        p->fromChip(CRIT_LO, CRIT_HI), p->critFilter,
+                        signals, *p->path);
+    }
+
+    tabulate(*p, false);
+    signals.flush();
+}
+
+void MainLoop::readSensor(Polled& p, size_t retries)
+{
+    Reading fault{0, 0};
+    Reading input{0, 0};
+
+    if (p.fault)
+    {
+        fault.first = ioAccess->tryRead(*p.fault, fault.second);
+    }
+    input.first = ioAccess->tryRead(p.input, input.second);
+    if (hwmonio::isGone(fault.first) || hwmonio::isGone(input.first))
+    {
+        gone();
+        return;
+    }
+
+    update(p, fault, input, retries);
+}
+
+void MainLoop::update(
+        Polled& p,
+        const Reading& faultReading,
+        const Reading& inputReading,
+        size_t retries)
+{
+    static constexpr auto skipSignal = true;
+    auto& i = *p.sensor;
+
+    try
+    {
+        if (p.status)
+        {
+            auto fault = result(i.first, faultReading, retries);
+            if (!fault)
+            {
+                return;
+            }
+            auto functional = (*fault == 0) ? true : false;
+            if (p.status->functional() != functional)
+            {
+                p.status->functional(functional, skipSignal);
+                signals.changed(*p.path,
+                                statusIfaceName,
+                                "Functional");
+            }
+            if (!functional)
+            {
+                refreshed(i.first);
+                tabulate(p, false);
+                return;
+            }
+        }
+
+        auto input = result(i.first, inputReading, retries);
+        if (!input)
+        {
+            return;
+        }
+
+        auto value = p.object->adjustValue(*input);
+        p.reading = value;
+        refreshed(i.first);
+
+        if (p.history && p.history->add(value))
+        {
+            signals.changed(*p.path,
+                            phosphor::hwmon::SensorHistory::interfaceName,
+                            "Statistics");
+        }
+
+        if (p.filtered)
+        {
+            publish(p, value);
+        }
+        else if (p.value && p.value->value() != value)
+        {
+            p.value->value(value, skipSignal);
+            signals.changed(*p.path, valueIfaceName, "Value");
+        }
+        if (p.warn)
+        {
+            sampleThresholds(*p.warn, p.warnFilter, value);
+            checkThresholds(*p.warn, value, p.hardware(WARN_LO, WARN_HI),
+                            p.fromChip(WARN_LO, WARN_HI), p.warnFilter,
+                            signals, *p.path);
+        }
+        if (p.crit)
+        {
+            sampleThresholds(*p.crit, p.critFilter, value);
+            checkThresholds(*p.crit, value, p.hardware(CRIT_LO, CRIT_HI),
+                            p.fromChip(CRIT_LO, CRIT_HI), p.critFilter,
+                            signals, *p.path);
+        }
+
+        tabulate(p, true);
+    }
+    catch (const std::system_error& e)
+    {
+        auto file = sysfs::make_sysfs_path(
+                ioAccess->path(),
+                i.first.first,
+                i.first.second,
+                hwmon::entry::cinput);
+#ifndef REMOVE_ON_FAIL
+        // Check sensorAdjusts for sensor removal RCs
+        auto& sAdjusts = p.object->getAdjusts();
+        if (sAdjusts.rmRCs.count(e.code().value()) > 0)
+        {
+            // Return code found in sensor return code removal list
+            if (rmSensors.find(i.first) == rmSensors.end())
+            {
+                // Trace for sensor not already removed from dbus
+                log<level::INFO>(
+                        "Remove sensor from dbus for read fail",
+                        entry("FILE=%s", file.c_str()),
+                        entry("RC=%d", e.code().value()));
+                // Mark this sensor to be removed from dbus
+                rmSensors[i.first] = std::get<0>(i.second);
+            }
+            return;
+        }
 #endif
-                using namespace sdbusplus::xyz::openbmc_project::
-                    Sensor::Device::Error;
-                report<ReadFailure>(
-                        xyz::openbmc_project::Sensor::Device::
-                            ReadFailure::CALLOUT_ERRNO(e.code().value()),
-                        xyz::openbmc_project::Sensor::Device::
-                            ReadFailure::CALLOUT_DEVICE_PATH(
-                                _devPath.c_str()));
-
-                log<level::INFO>("Logging failing sysfs file",
-                        entry("FILE=%s", file.c_str()));
+        using namespace sdbusplus::xyz::openbmc_project::
+            Sensor::Device::Error;
+        report<ReadFailure>(
+                xyz::openbmc_project::Sensor::Device::
+                    ReadFailure::CALLOUT_ERRNO(e.code().value()),
+                xyz::openbmc_project::Sensor::Device::
+                    ReadFailure::CALLOUT_DEVICE_PATH(
+                        _devPath.c_str()));
+
+        log<level::INFO>("Logging failing sysfs file",
+                entry("FILE=%s", file.c_str()));
 
 #ifdef REMOVE_ON_FAIL
-                rmSensors[i.first] = std::get<0>(i.second);
+        rmSensors[i.first] = std::get<0>(i.second);
 #else
-                exit(EXIT_FAILURE);
+        stop(EXIT_FAILURE);
+#endif
+    }
+}
+
+void MainLoop::publish(Polled& p, int64_t value)
+{
+    // Keep the property current for readers, but only signal it
+    // when it is worth it.
+    static constexpr auto skipSignal = true;
+    p.value->value(value, skipSignal);
+
+    auto now = std::chrono::steady_clock::now();
+    auto beat = p.heartbeat.count() && now - p.lastPublished >= p.heartbeat;
+    if (!beat && !p.deadband.exceeded(p.published, value))
+    {
+        return;
+    }
+
+    p.published = value;
+    p.lastPublished = now;
+
+    signals.changed(*p.path, valueIfaceName, "Value");
+}
+
+optional_ns::optional<int64_t> MainLoop::result(
+        const SensorSet::key_type& sensor,
+        const Reading& reading,
+        size_t retries)
+{
+    auto rc = reading.first;
+    if (!rc)
+    {
+        return reading.second;
+    }
+
+    if (retries && hwmonio::isRetryable(rc))
+    {
+        // Don't hold up the other sensors, try this one again later.
+        scheduleRetry(sensor, retries - 1);
+        return {};
+    }
+
+#ifdef NEGATIVE_ERRNO_ON_FAIL
+    return -rc;
 #endif
+
+    throw std::system_error(rc, std::generic_category());
+}
+
+void MainLoop::scheduleRetry(const SensorSet::key_type& sensor, size_t retries)
+{
+    auto& retry = retryQueue[sensor];
+    retry.retries = retries;
+    if (!retry.pending)
+    {
+        retry.pending = true;
+        ++pendingRetries;
+    }
+
+    if (!retry.timer)
+    {
+        std::function<void()> callback(std::bind(
+                &MainLoop::retry, this, sensor));
+        retry.timer = std::make_unique<phosphor::hwmon::Timer>(
+                loop, callback,
+                hwmonio::delay,
+                phosphor::hwmon::timer::ONESHOT);
+    }
+    else
+    {
+        retry.timer->start(hwmonio::delay, phosphor::hwmon::timer::ONESHOT);
+    }
+}
+
+void MainLoop::retry(const SensorSet::key_type& sensor)
+{
+    auto& retry = retryQueue[sensor];
+
+    if (pool && pool->busy())
+    {
+        // The pool may be using the sensor's attributes and the sensor
+        // state, try again once it's done.
+        retry.timer->start(hwmonio::delay, phosphor::hwmon::timer::ONESHOT);
+        return;
+    }
+
+    retry.pending = false;
+    --pendingRetries;
+
+    auto p = std::find_if(
+            polled.begin(),
+            polled.end(),
+            [&sensor](const auto& p)
+            {
+                return p.sensor->first == sensor;
+            });
+    if (p == polled.end())
+    {
+        // The sensor was removed while waiting on the retry.
+        return;
+    }
+
+    readSensor(*p, retry.retries);
+    if (stopped())
+    {
+        return;
+    }
+    signals.flush();
+
+    if (rmSensors.find(sensor) != rmSensors.end())
+    {
+        histories.erase(sensor);
+        state.erase(p->sensor);
+        buildBatch();
+    }
+}
+
+void MainLoop::read()
+{
+    // TODO: Issue#3 - Need to make calls to the dbus sensor cache here to
+    //       ensure the objects all exist?
+
+    auto busy = pool && pool->busy();
+    stats->tick(timer->getLateness(), timer->getMissed() + (busy ? 1 : 0));
+
+    if (busy)
+    {
+        // The last tick is still being read.  Skip this one without
+        // advancing the schedule so no sensor misses its turn.
+        return;
+    }
+
+    due.clear();
+    wheel.advance(due);
+
+    // Sensors waiting on a retry are read when their retry timer expires.
+    if (pendingRetries)
+    {
+        auto pending = [this](size_t i)
+        {
+            auto retry = retryQueue.find(polled[i].sensor->first);
+            return retry != retryQueue.end() && retry->second.pending;
+        };
+        due.erase(std::remove_if(due.begin(), due.end(), pending),
+                  due.end());
+    }
+
+    batch.clear();
+    for (auto i : due)
+    {
+        auto& p = polled[i];
+        if (p.fault)
+        {
+            batch.push_back(*p.fault);
+        }
+        batch.push_back(p.input);
+        for (size_t n = 0; n < 4; ++n)
+        {
+            if (p.polledAlarms & (1 << n))
+            {
+                batch.push_back(p.alarmInputs[n]);
             }
         }
     }
 
+    cycleStart = std::chrono::steady_clock::now();
+
+    if (pool && !batch.empty())
+    {
+        // The tick is finished by complete() once the pool has read
+        // everything.
+        pool->submit(batch, values, errors);
+        return;
+    }
+
+    // Read every due attribute in one go.
+    ioAccess->readBatch(batch, values, errors);
+    complete();
+}
+
+void MainLoop::complete()
+{
+    if (stopped())
+    {
+        // Read before the device stopped, it's waiting to be destroyed.
+        return;
+    }
+
+    stats->cycle(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - cycleStart));
+
+    if (std::any_of(errors.begin(), errors.end(), hwmonio::isGone))
+    {
+        gone();
+        return;
+    }
+
+    // Readers of the sensor table see the whole cycle at once.
+    if (sensorTable)
+    {
+        sensorTable->begin();
+    }
+
+    // Iterate through the sensors that were due, their readings
+    // are in the batch in the same order.
+    size_t pos = 0;
+    for (auto i : due)
+    {
+        if (stopped())
+        {
+            break;
+        }
+
+        auto& p = polled[i];
+
+        Reading fault{0, 0};
+        if (p.fault)
+        {
+            fault = std::make_pair(errors[pos], values[pos]);
+            ++pos;
+        }
+        Reading input = std::make_pair(errors[pos], values[pos]);
+        ++pos;
+        for (size_t n = 0; n < 4; ++n)
+        {
+            if (!(p.polledAlarms & (1 << n)))
+            {
+                continue;
+            }
+            // An alarm that can't be read keeps its last state.
+            if (!errors[pos])
+            {
+                p.alarms = values[pos] ? (p.alarms | (1 << n)) :
+                                         (p.alarms & ~(1 << n));
+            }
+            ++pos;
+        }
+
+        // Transient errors are retried from the event loop
+        // so other sensors are not held up.
+        update(p, fault, input, hwmonio::retries);
+    }
+
+    if (sensorTable)
+    {
+        sensorTable->end();
+    }
+
+    if (stopped())
+    {
+        return;
+    }
+
+    // Emit the changes of the whole cycle together, before any of the
+    // objects they refer to can be removed.
+    signals.flush();
+
     // Remove any sensors marked for removal
+    auto changed = false;
     for (auto& i : rmSensors)
     {
-        state.erase(i.first);
+        histories.erase(i.first);
+        changed |= (state.erase(i.first) > 0);
     }
 
 #ifndef REMOVE_ON_FAIL
@@ -519,10 +2259,11 @@ void MainLoop::read()
                                              std::move((*object).second));
 
                 state[std::move(ssValueType.first)] = std::move(value);
+                changed = true;
 
                 // Sensor object added, erase entry from removal list
                 auto file = sysfs::make_sysfs_path(
-                        ioAccess.path(),
+                        ioAccess->path(),
                         it->first.first,
                         it->first.second,
                         hwmon::entry::cinput);
@@ -543,6 +2284,16 @@ void MainLoop::read()
         }
     }
 #endif
+
+    if (changed)
+    {
+        buildBatch();
+    }
+
+    if (reloadPending)
+    {
+        reload();
+    }
 }
 
 // vim: tabstop=8 expandtab shiftwidth=4 softtabstop=4
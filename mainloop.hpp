@@ -1,20 +1,46 @@
 #pragma once
 
+#include <set>
 #include <string>
 #include <vector>
 #include <experimental/any>
 #include <experimental/optional>
+#include <functional>
 #include <memory>
 #include <sdbusplus/server.hpp>
 #include "types.hpp"
+#include "deadband.hpp"
 #include "hwmonio.hpp"
+#include "env.hpp"
+#include "sensorconfig.hpp"
 #include "sensorset.hpp"
 #include "sysfs.hpp"
 #include "interface.hpp"
 #include "timer.hpp"
+#include "timerwheel.hpp"
+#include "pollstats.hpp"
+#include "hotplug.hpp"
+#include "notify.hpp"
+#include "propertysignals.hpp"
+#include "readpool.hpp"
 #include "sensor.hpp"
+#include "sensorhistory.hpp"
+#include "sensortable.hpp"
+#include "snapshot.hpp"
 
 static constexpr auto default_interval = 1000000;
+/** @brief Least time to poll after the driver's update_interval. */
+static constexpr auto update_margin = 1000;
+/** @brief Shortest scheduler tick used for per-sensor intervals. */
+static constexpr auto min_tick = 10000;
+/** @brief D-Bus namespace of the devices' polling statistics. */
+static constexpr auto stats_root = "/xyz/openbmc_project/hwmon";
+/** @brief Directory of the restart snapshots, on tmpfs. */
+static constexpr auto snapshot_dir = "/run/phosphor-hwmon";
+/** @brief Default age past which a restart snapshot is ignored. */
+static constexpr auto default_snapshot_max_age = 60000000;
+/** @brief Default number of threads for the initial reads. */
+static constexpr auto default_init_threads = 4;
 
 static constexpr auto sensorID = 0;
 static constexpr auto sensorLabel = 1;
@@ -31,9 +57,11 @@ class MainLoop
         MainLoop() = delete;
         MainLoop(const MainLoop&) = delete;
         MainLoop& operator=(const MainLoop&) = delete;
-        MainLoop(MainLoop&&) = default;
-        MainLoop& operator=(MainLoop&&) = default;
-        ~MainLoop() = default;
+        MainLoop(MainLoop&&) = delete;
+        MainLoop& operator=(MainLoop&&) = delete;
+
+        /** @brief Removes the device's objects and releases its busname. */
+        ~MainLoop();
 
         /** @brief Constructor
          *
@@ -58,10 +86,68 @@ class MainLoop
             const char* prefix,
             const char* root);
 
+        /** @brief Constructor for a device sharing a process with others
+         *
+         *  @param[in] bus - shared sdbusplus bus client connection.
+         *  @param[in] param - the path parameter provided
+         *  @param[in] path - hwmon sysfs instance to manage
+         *  @param[in] devPath - physical device sysfs path.
+         *  @param[in] prefix - DBus busname prefix.
+         *  @param[in] root - DBus sensors namespace root.
+         *  @param[in] settings - the device's environment settings.
+         *
+         *  The object managers for the DBus sensors namespace root and
+         *  stats_root are left to the caller, so they can be shared
+         *  between devices.
+         *  The connection stays the caller's and must outlive the
+         *  device.  The device's settings are used in place of the
+         *  process environment.
+         */
+        MainLoop(
+            sdbusplus::bus::bus& bus,
+            const std::string& param,
+            const std::string& path,
+            const std::string& devPath,
+            const char* prefix,
+            const char* root,
+            env::Settings settings);
+
         /** @brief Setup polling timer in a sd event loop and attach to D-Bus
          *         event loop.
+         *
+         *  @return The exit status, once the device has stopped.
+         */
+        int run();
+
+        /** @brief Set up D-Bus objects and the polling timer in an
+         *         existing sd event loop.
+         *
+         *  Used when several devices share an event loop, run() does
+         *  this itself.
+         *
+         *  @param[in] event - the sd event loop to poll in
+         *  @param[in] stopped - called when the device stops, from one
+         *                       of its handlers, so the device may only
+         *                       be destroyed once that returns
+         *
+         *  @return false if the device has no sensors to monitor, or
+         *          stopped while they were set up.
+         */
+        bool start(sd_event* event, std::function<void()> stopped);
+
+        /** @brief Whether the device stopped, on failure or because it
+         *         went away.
          */
-        void run();
+        bool stopped() const
+        {
+            return static_cast<bool>(exitStatus);
+        }
+
+        /** @brief The exit status of a stopped device. */
+        int status() const
+        {
+            return exitStatus.value_or(0);
+        }
 
         /** @brief Stop polling timer event loop from another thread.
          *
@@ -69,20 +155,276 @@ class MainLoop
          */
         void shutdown() noexcept;
 
+        /** @brief Re-read the settings and apply what changed.
+         *
+         *  Thresholds, adjustments and polling settings are changed
+         *  on the live objects.  Sensors whose label or interfaces
+         *  change are recreated, the others are left alone.
+         */
+        void reload();
+
     private:
+        /** @brief Common constructor, without an object manager.
+         *
+         *  Uses the shared connection if there is one, otherwise the
+         *  owned one.
+         */
+        MainLoop(
+            std::unique_ptr<sdbusplus::bus::bus> ownBus,
+            sdbusplus::bus::bus* sharedBus,
+            const std::string& param,
+            const std::string& path,
+            const std::string& devPath,
+            const char* prefix,
+            const char* root,
+            std::unique_ptr<env::Settings> settings);
+
         using mapped_type = std::tuple<SensorSet::mapped_type, std::string, ObjectInfo>;
         using SensorState = std::map<SensorSet::key_type, mapped_type>;
 
         /** @brief Read hwmon sysfs entries */
         void read();
 
-        /** @brief Set up D-Bus object state */
-        void init();
+        /** @brief Update D-Bus objects from a poll cycle's batch read */
+        void complete();
+
+        /** @brief Outcome of an attribute read: errno and value. */
+        using Reading = std::pair<int, int64_t>;
+
+        /** @brief Build the list of polled sensors and their schedule. */
+        void buildBatch();
+
+        /** @brief Hardware alarm attributes, as bits of Polled::alarms. */
+        enum Alarm : uint8_t
+        {
+            WARN_LO = 1 << 0,
+            WARN_HI = 1 << 1,
+            CRIT_LO = 1 << 2,
+            CRIT_HI = 1 << 3,
+            FAULT = 1 << 4,
+        };
+
+        struct Polled;
+
+        /** @brief Stop monitoring the device, its directory or the
+         *         device itself disappeared.
+         *
+         *  The readers only report it, this is called from the event
+         *  loop once no read is in progress.
+         */
+        void gone();
+
+        /** @brief Stop monitoring the device.
+         *
+         *  Its handlers ignore any further events, and the stopped
+         *  callback is left to destroy it and its objects.
+         *
+         *  @param[in] status - The exit status.
+         */
+        void stop(int status);
+
+        /** @brief Read a single sensor and update its D-Bus objects.
+         *
+         *  @param[in] sensor - The sensor to update.
+         *  @param[in] retries - Retries remaining on transient errors.
+         */
+        void readSensor(Polled& sensor, size_t retries);
+
+        /** @brief Update a sensor's D-Bus objects from its readings.
+         *
+         *  @param[in] sensor - The sensor to update.
+         *  @param[in] fault - The fault attribute reading, if it has one.
+         *  @param[in] input - The input attribute reading.
+         *  @param[in] retries - Retries remaining on transient errors.
+         */
+        void update(
+                Polled& sensor,
+                const Reading& fault,
+                const Reading& input,
+                size_t retries);
+
+        /** @brief Update a sensor's value, signalling it if it
+         *         moved out of the deadband or the heartbeat expired.
+         *
+         *  @param[in] sensor - The sensor to update.
+         *  @param[in] value - The new value.
+         */
+        void publish(Polled& sensor, int64_t value);
+
+        /** @brief Check the outcome of an attribute read.
+         *
+         *  On a transient error with retries remaining, the sensor
+         *  is queued for a retry and nothing is returned.  Other
+         *  errors are thrown as std::system_error.
+         *
+         *  @param[in] sensor - The sensor that was read.
+         *  @param[in] reading - The attribute reading.
+         *  @param[in] retries - Retries remaining on transient errors.
+         *
+         *  @return - Optional
+         *      The read value, nothing if a retry was scheduled
+         */
+        optional_ns::optional<int64_t> result(
+                const SensorSet::key_type& sensor,
+                const Reading& reading,
+                size_t retries);
+
+        /** @brief Queue a sensor to be read again after hwmonio::delay.
+         *
+         *  @param[in] sensor - The sensor to retry.
+         *  @param[in] retries - Retries remaining after the next one.
+         */
+        void scheduleRetry(const SensorSet::key_type& sensor, size_t retries);
+
+        /** @brief Retry timer expiry handler for a queued sensor.
+         *
+         *  @param[in] sensor - The sensor to retry.
+         */
+        void retry(const SensorSet::key_type& sensor);
+
+        /** @brief Watch a polled sensor's alarm attribute, if it has it.
+         *
+         *  @param[in] sensor - Index of the sensor in polled.
+         *  @param[in] alarm - The alarm.
+         *  @param[in] attribute - The alarm attribute (ex. max_alarm).
+         *
+         *  @return Whether the attribute is watched.
+         */
+        bool watchAlarm(size_t sensor, Alarm alarm, const char* attribute);
+
+        /** @brief Evaluate a sensor's alarm against its new threshold.
+         *
+         *  @param[in] sensor - The sensor whose threshold was set.
+         *  @param[in] type - The threshold's interface.
+         *  @param[in] high - Whether the high limit was set, else the low.
+         */
+        void thresholdsChanged(const SensorSet::key_type& sensor,
+                               InterfaceType type,
+                               bool high);
+
+        /** @brief Update a sensor's D-Bus objects from a hardware alarm.
+         *
+         *  @param[in] sensor - Index of the sensor in polled.
+         *  @param[in] alarm - The alarm.
+         *  @param[in] value - The alarm attribute value.
+         */
+        void alarm(size_t sensor, Alarm alarm, int64_t value);
+
+        /** @brief Poll at the driver's update_interval, setting it first
+         *         if UPDATE_INTERVAL asks for one.
+         */
+        void alignInterval();
+
+        /** @brief Set the polling interval from the settings and
+         *         the driver's update_interval.
+         */
+        void configureInterval();
+
+        /** @brief The initial readings of a sensor. */
+        struct Prefetch
+        {
+            /** @brief The fault attribute reading, if it has one. */
+            optional_ns::optional<Reading> fault;
+            /** @brief The input attribute reading. */
+            Reading input;
+        };
+
+        /** @brief Read the sensors that will get objects concurrently
+         *
+         *  @param[in] sensors - The sensors found in sysfs.
+         *  @param[in] skip - Sensors that don't need reading.
+         *
+         *  @return The readings of each sensor read.
+         */
+        std::map<SensorSet::key_type, Prefetch> prefetch(
+                SensorSet& sensors,
+                const std::map<SensorSet::key_type,
+                               phosphor::hwmon::snapshot::Entry>& skip);
+
+        /** @brief Fill in unset thresholds from the chip's limits
+         *
+         *  Warning thresholds come from the min and max attributes and
+         *  critical thresholds from lcrit and crit, adjusted like the
+         *  value.  A kind of threshold with either limit in the settings
+         *  is left alone.  The limit a chip doesn't have never alarms.
+         *
+         *  @param[in] sensor - The sensor.
+         *  @param[in] object - The sensor's value adjustments.
+         *  @param[in,out] thresholds - The sensor's threshold settings.
+         *  @param[out] limited - The alarms whose limits were read.
+         *
+         *  @return The hardware alarms that replace the threshold
+         *          comparisons, those of the limits with alarm attributes.
+         */
+        uint8_t chipThresholds(
+                SensorSet::container_t::const_reference sensor,
+                sensor::Sensor& object,
+                config::Sensor& thresholds,
+                uint8_t& limited);
+
+        /** @brief Add, replace or remove a sensor's history to match
+         *         its settings.
+         *
+         *  @param[in] sensor - The sensor.
+         *  @param[in] path - The sensor's D-Bus object path.
+         *  @param[in] config - The settings to follow.
+         *  @param[in] announce - Whether the sensor's object was already
+         *                        announced.
+         */
+        void addHistory(const SensorSet::key_type& sensor,
+                        const std::string& path,
+                        const config::Device& config,
+                        bool announce);
+
+        /** @brief Open or close the shared sensor table to match the
+         *         settings. */
+        void openTable();
+
+        /** @brief Copy a polled sensor's state to the sensor table.
+         *
+         *  @param[in] sensor - The sensor.
+         *  @param[in] read - Whether its value was just read.
+         */
+        void tabulate(const Polled& sensor, bool read);
+
+        /** @brief Save the sensor states to the restart snapshot */
+        void saveSnapshot();
+
+        /** @brief Note a sensor has been read since the restart.
+         *
+         *  @param[in] sensor - The sensor that was read.
+         */
+        void refreshed(const SensorSet::key_type& sensor);
+
+        /** @brief Add and remove sensors to match the hwmon directory */
+        void rescan();
+
+        /** @brief Add and remove sensors to match the hwmon directory,
+         *         without rebuilding the polled sensors.
+         *
+         *  @return whether any sensors were added or removed.
+         */
+        bool resync();
+
+        /** @brief Set up D-Bus object state
+         *
+         *  @return false if the device has no sensors to monitor.
+         */
+        bool init();
 
+        /** @brief The connection, when it isn't shared with other
+         *         devices. */
+        std::unique_ptr<sdbusplus::bus::bus> _ownBus;
         /** @brief sdbusplus bus client connection. */
-        sdbusplus::bus::bus _bus;
-        /** @brief sdbusplus freedesktop.ObjectManager storage. */
-        sdbusplus::server::manager::manager _manager;
+        sdbusplus::bus::bus& _bus;
+        /** @brief The busname requested, if any. */
+        std::string _busName;
+        /** @brief sdbusplus freedesktop.ObjectManager storage, unless
+         *         it's shared with other devices. */
+        std::unique_ptr<sdbusplus::server::manager::manager> _manager;
+        /** @brief freedesktop.ObjectManager of stats_root, unless it's
+         *         shared with other devices. */
+        std::unique_ptr<sdbusplus::server::manager::manager> _statsManager;
         /** @brief the parameter path used. */
         std::string _pathParam;
         /** @brief hwmon sysfs class path. */
@@ -95,19 +437,169 @@ class MainLoop
         const char* _prefix;
         /** @brief DBus sensors namespace root. */
         const char* _root;
+        /** @brief The device's settings, if not the process environment. */
+        std::unique_ptr<env::Settings> _settings;
+        /** @brief The parsed settings of the device and its sensors. */
+        config::Device _config;
         /** @brief DBus object state. */
         SensorState state;
+        /** @brief PropertiesChanged signals of the sensor objects. */
+        phosphor::hwmon::PropertySignals signals;
         /** @brief Sleep interval in microseconds. */
         uint64_t _interval = default_interval;
+        /** @brief Scheduler tick in microseconds. */
+        uint64_t _tick = default_interval;
         /** @brief Hwmon sysfs access. */
-        hwmonio::HwmonIO ioAccess;
+        std::unique_ptr<hwmonio::HwmonIO> ioAccess;
+        /** @brief Number of sysfs reader threads, zero for none. */
+        size_t _readThreads = 0;
+        /** @brief Sysfs reader threads, when configured. */
+        std::unique_ptr<phosphor::hwmon::ReadPool> pool;
         /** @brief Timer */
         std::unique_ptr<phosphor::hwmon::Timer> timer;
+        /** @brief Watch for sensors coming and going. */
+        std::unique_ptr<phosphor::hwmon::HotPlug> hotplug;
+        /** @brief Polling loop statistics. */
+        std::unique_ptr<phosphor::hwmon::PollStatistics> stats;
+        /** @brief When the current poll cycle started. */
+        std::chrono::steady_clock::time_point cycleStart;
         /** @brief the sd_event structure */
         sd_event* loop = nullptr;
+        /** @brief Called when the device stops. */
+        std::function<void()> _stopped;
+        /** @brief Exit status, once the device has stopped. */
+        optional_ns::optional<int> exitStatus;
         /** @brief Store the specifications of sensor objects */
         std::map<SensorSet::key_type,
                  std::unique_ptr<sensor::Sensor>> sensorObjects;
+        /** @brief Hardware alarms that replace the threshold comparisons
+         *         of the sensors with limits read from the chip. */
+        std::map<SensorSet::key_type, uint8_t> chipAlarms;
+        /** @brief Recent readings of the sensors with HISTORY set. */
+        std::map<SensorSet::key_type,
+                 std::unique_ptr<phosphor::hwmon::SensorHistory>> histories;
+
+        /** @brief A sensor waiting to be read again. */
+        struct Retry
+        {
+            /** @brief Retries remaining after the pending one. */
+            size_t retries = 0;
+            /** @brief Whether a retry is currently scheduled. */
+            bool pending = false;
+            /** @brief Retry timer, reused across retries. */
+            std::unique_ptr<phosphor::hwmon::Timer> timer;
+        };
+
+        /** @brief Sensors with transient read errors */
+        std::map<SensorSet::key_type, Retry> retryQueue;
+        /** @brief Number of sensors with a retry scheduled. */
+        size_t pendingRetries = 0;
+        /** @brief Whether a reload is waiting for the pool to finish. */
+        bool reloadPending = false;
+
+        /** @brief Restart snapshot file. */
+        std::string _snapshotPath;
+        /** @brief Shared memory table of the sensor states. */
+        std::unique_ptr<phosphor::hwmon::SensorTable> sensorTable;
+        /** @brief Timer to save the restart snapshot. */
+        std::unique_ptr<phosphor::hwmon::Timer> snapshotTimer;
+        /** @brief Sensors published from the restart snapshot that
+         *         haven't been read since.
+         */
+        std::set<SensorSet::key_type> stale;
+
+        /** @brief A polled sensor, resolved for the poll loop.
+         *
+         *  The pointers refer to objects owned by the sensor's state
+         *  and sensorObjects, so the records are rebuilt whenever
+         *  sensors are added or removed.
+         */
+        struct Polled
+        {
+            SensorState::iterator sensor;
+            /** @brief The sensor's key, valid after it's removed. */
+            SensorSet::key_type key;
+            /** @brief The input attribute. */
+            hwmonio::HwmonIO::Attribute input = 0;
+            /** @brief The fault attribute, if it has one. */
+            optional_ns::optional<hwmonio::HwmonIO::Attribute> fault;
+            /** @brief Poll interval in microseconds. */
+            uint64_t interval = default_interval;
+            /** @brief The sensor's D-Bus object path. */
+            const std::string* path = nullptr;
+            /** @brief The sensor's value adjustments. */
+            sensor::Sensor* object = nullptr;
+            ValueObject* value = nullptr;
+            WarningObject* warn = nullptr;
+            CriticalObject* crit = nullptr;
+            StatusObject* status = nullptr;
+            /** @brief Index of the sensor's record in the table. */
+            size_t slot = phosphor::hwmon::SensorTable::npos;
+            /** @brief Recent readings, if they're kept. */
+            phosphor::hwmon::SensorHistory* history = nullptr;
+            /** @brief Whether the value is only published on change. */
+            bool filtered = false;
+            /** @brief Band around the published value to not publish. */
+            hwmon::Deadband deadband;
+            /** @brief Longest time to go without publishing, if any. */
+            std::chrono::microseconds heartbeat{};
+            /** @brief The last published value. */
+            int64_t published = 0;
+            /** @brief The last reading, adjusted. */
+            int64_t reading = 0;
+            /** @brief When the value was last published. */
+            std::chrono::steady_clock::time_point lastPublished;
+            /** @brief Hardware alarms raised, from the alarm attributes. */
+            uint8_t alarms = 0;
+            /** @brief Hardware alarms that replace the threshold
+             *         comparisons, for limits read from the chip. */
+            uint8_t chip = 0;
+            /** @brief Hardware alarms read with the input, when they
+             *         aren't watched. */
+            uint8_t polledAlarms = 0;
+            /** @brief The alarm attributes of polledAlarms, by bit. */
+            hwmonio::HwmonIO::Attribute alarmInputs[4] = {};
+            /** @brief Hysteresis and debounce of the warning alarms. */
+            hwmon::AlarmFilter warnFilter;
+            /** @brief Hysteresis and debounce of the critical alarms. */
+            hwmon::AlarmFilter critFilter;
+
+            /** @brief The hardware low and high alarms of a kind. */
+            std::pair<bool, bool> hardware(Alarm lo, Alarm hi) const
+            {
+                return std::make_pair((alarms & lo) != 0,
+                                      (alarms & hi) != 0);
+            }
+
+            /** @brief Whether the low and high alarms of a kind are
+             *         left to the hardware. */
+            std::pair<bool, bool> fromChip(Alarm lo, Alarm hi) const
+            {
+                return std::make_pair((chip & lo) != 0,
+                                      (chip & hi) != 0);
+            }
+        };
+
+        /** @brief Polled sensors, built by buildBatch(). */
+        std::vector<Polled> polled;
+        /** @brief Sensors whose objects were created since the last
+         *         buildBatch(), which don't carry their polled state
+         *         over. */
+        std::set<SensorSet::key_type> created;
+        /** @brief Whether to watch the hardware alarm attributes. */
+        bool _alarmEvents = false;
+        /** @brief Watches on the polled sensors' alarm attributes. */
+        std::vector<std::unique_ptr<phosphor::hwmon::Notify>> notifiers;
+        /** @brief Schedule of the polled sensors, in ticks. */
+        phosphor::hwmon::TimerWheel wheel;
+        /** @brief Polled sensors due on the current tick. */
+        std::vector<size_t> due;
+        /** @brief Attributes of the sensors due on the current tick. */
+        std::vector<hwmonio::HwmonIO::Attribute> batch;
+        /** @brief Values of the last batch read. */
+        std::vector<int64_t> values;
+        /** @brief Errors of the last batch read. */
+        std::vector<int> errors;
 
         /**
          * @brief Map of removed sensors
@@ -133,10 +625,16 @@ class MainLoop
          * @brief Used to create and add sensor objects
          *
          * @param[in] sensor - Sensor to create/add object for
+         * @param[in] restored - The sensor's state from the restart
+         *                       snapshot, used instead of reading it
+         * @param[in] prefetched - The sensor's readings, used instead
+         *                         of reading it unless they failed
          *
          * @return - Optional
          *     Object state data on success, nothing on failure
          */
         optional_ns::optional<ObjectStateData> getObject(
-                SensorSet::container_t::const_reference sensor);
+                SensorSet::container_t::const_reference sensor,
+                const phosphor::hwmon::snapshot::Entry* restored = nullptr,
+                const Prefetch* prefetched = nullptr);
 };
@@ -0,0 +1,107 @@
+/**
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <system_error>
+#include <unistd.h>
+
+#include "hwmonio.hpp"
+#include "notify.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+Notify::Notify(sd_event* event, const std::string& path, Callback callback) :
+    fd(open(path.c_str(), O_RDONLY | O_CLOEXEC)),
+    callback(callback)
+{
+    if (!fd)
+    {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    // Reading the attribute also rearms the notification.
+    auto rc = read();
+    if (rc)
+    {
+        throw std::system_error(rc, std::generic_category(), path);
+    }
+
+    auto r = sd_event_add_io(event, &eventSource, fd(), EPOLLPRI,
+                             handler, this);
+    if (r < 0)
+    {
+        throw std::system_error(-r, std::generic_category(), path);
+    }
+}
+
+Notify::~Notify()
+{
+    if (eventSource)
+    {
+        eventSource = sd_event_source_unref(eventSource);
+    }
+}
+
+int Notify::read()
+{
+    char buf[32];
+
+    auto size = pread(fd(), buf, sizeof(buf) - 1, 0);
+    if (size < 0)
+    {
+        return errno;
+    }
+
+    buf[size] = '\0';
+    char* end = nullptr;
+    errno = 0;
+    auto v = std::strtoll(buf, &end, 10);
+    if (end == buf || errno)
+    {
+        return errno ? errno : EINVAL;
+    }
+
+    value = v;
+    return 0;
+}
+
+int Notify::handler(sd_event_source* eventSource,
+                    int fd, uint32_t revents, void* userData)
+{
+    auto notify = static_cast<Notify*>(userData);
+
+    // A failed read leaves the value for the poll loop to sort out.
+    auto rc = notify->read();
+    if (!rc)
+    {
+        notify->callback(notify->value);
+    }
+    else if (hwmonio::isGone(rc))
+    {
+        // An unbound attribute reports events without end, so stop
+        // watching until the poll loop notices the device is gone.
+        sd_event_source_set_enabled(eventSource, SD_EVENT_OFF);
+    }
+
+    return 0;
+}
+
+} // namespace hwmon
+} // namespace phosphor
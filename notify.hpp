@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <systemd/sd-event.h>
+
+#include "hwmonio.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+/** @class Notify
+ *  @brief Watches a sysfs attribute for sysfs_notify() events.
+ *
+ *  Drivers call sysfs_notify() on attributes such as alarms and
+ *  faults when they change, which wakes POLLPRI pollers.  The
+ *  attribute is read again on each event and its value handed to the
+ *  callback.
+ */
+class Notify
+{
+    public:
+        using Callback = std::function<void(int64_t)>;
+
+        Notify() = delete;
+        Notify(const Notify&) = delete;
+        Notify& operator=(const Notify&) = delete;
+        Notify(Notify&&) = delete;
+        Notify& operator=(Notify&&) = delete;
+        ~Notify();
+
+        /** @brief Constructs the watch
+         *
+         *  @param[in] event - sd_event loop to watch in
+         *  @param[in] path - the sysfs attribute to watch
+         *  @param[in] callback - called with the attribute's new value
+         *
+         *  Throws std::system_error if the attribute can't be opened
+         *  or watched.
+         */
+        Notify(sd_event* event, const std::string& path, Callback callback);
+
+        /** @brief The attribute value read when the watch was set up */
+        int64_t initial() const
+        {
+            return value;
+        }
+
+    private:
+        /** @brief POLLPRI event handler */
+        static int handler(sd_event_source* eventSource,
+                           int fd, uint32_t revents, void* userData);
+
+        /** @brief Read the attribute value, rearming the notification
+         *
+         *  @return errno - Zero on success.
+         */
+        int read();
+
+        hwmonio::FileDescriptor fd;
+        sd_event_source* eventSource = nullptr;
+        Callback callback;
+
+        /** @brief The last value read */
+        int64_t value = 0;
+};
+
+} // namespace hwmon
+} // namespace phosphor
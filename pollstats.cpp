@@ -0,0 +1,148 @@
+/**
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <system_error>
+#include <string.h>
+
+#include "pollstats.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+static constexpr auto interface = "xyz.openbmc_project.Hwmon.PollStatistics";
+
+const sd_bus_vtable PollStatistics::vtable[] =
+{
+    SD_BUS_VTABLE_START(0),
+    SD_BUS_PROPERTY("MaxLateness", "t",
+                    get<&PollStatistics::maxLateness>, 0,
+                    SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+    SD_BUS_PROPERTY("Overruns", "t",
+                    get<&PollStatistics::overruns>, 0,
+                    SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+    SD_BUS_PROPERTY("MaxCycleTime", "t",
+                    get<&PollStatistics::maxCycleTime>, 0,
+                    SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+    SD_BUS_PROPERTY("StaleSensors", "t",
+                    get<&PollStatistics::staleSensors>, 0,
+                    SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+    SD_BUS_VTABLE_END
+};
+
+/** @brief Property names, in the order of the vtable. */
+static char maxLateness[] = "MaxLateness";
+static char overruns[] = "Overruns";
+static char maxCycleTime[] = "MaxCycleTime";
+static char* const names[] = {maxLateness, overruns, maxCycleTime};
+
+enum Changed : uint8_t
+{
+    MAX_LATENESS = 1 << 0,
+    OVERRUNS = 1 << 1,
+    MAX_CYCLE_TIME = 1 << 2,
+};
+
+template <uint64_t PollStatistics::*member>
+int PollStatistics::get(sd_bus* bus, const char* path,
+                        const char* interface, const char* property,
+                        sd_bus_message* reply, void* userData,
+                        sd_bus_error* error)
+{
+    auto stats = static_cast<PollStatistics*>(userData);
+    return sd_bus_message_append(reply, "t", stats->*member);
+}
+
+PollStatistics::PollStatistics(sdbusplus::bus::bus& bus,
+                               const std::string& path) :
+    bus(bus.get()),
+    path(path)
+{
+    auto r = sd_bus_add_object_vtable(bus.get(), &slot, path.c_str(),
+                                      interface, vtable, this);
+    if (r < 0)
+    {
+        throw std::system_error(-r, std::generic_category(), strerror(-r));
+    }
+
+    sd_bus_emit_interfaces_added(this->bus, path.c_str(), interface, nullptr);
+}
+
+PollStatistics::~PollStatistics()
+{
+    sd_bus_emit_interfaces_removed(bus, path.c_str(), interface, nullptr);
+    sd_bus_slot_unref(slot);
+}
+
+void PollStatistics::tick(std::chrono::microseconds late, uint64_t missed)
+{
+    if (static_cast<uint64_t>(late.count()) > maxLateness)
+    {
+        maxLateness = late.count();
+        changed |= MAX_LATENESS;
+    }
+    if (missed)
+    {
+        overruns += missed;
+        changed |= OVERRUNS;
+    }
+}
+
+void PollStatistics::cycle(std::chrono::microseconds time)
+{
+    if (static_cast<uint64_t>(time.count()) > maxCycleTime)
+    {
+        maxCycleTime = time.count();
+        changed |= MAX_CYCLE_TIME;
+    }
+
+    if (!changed)
+    {
+        return;
+    }
+
+    static constexpr auto count = sizeof(names) / sizeof(names[0]);
+    char* properties[count + 1] = {};
+    size_t n = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (changed & (1 << i))
+        {
+            properties[n++] = names[i];
+        }
+    }
+    changed = 0;
+
+    sd_bus_emit_properties_changed_strv(bus, path.c_str(), interface,
+                                        properties);
+}
+
+void PollStatistics::stale(uint64_t count)
+{
+    if (count == staleSensors)
+    {
+        return;
+    }
+
+    staleSensors = count;
+
+    char property[] = "StaleSensors";
+    char* properties[] = {property, nullptr};
+    sd_bus_emit_properties_changed_strv(bus, path.c_str(), interface,
+                                        properties);
+}
+
+} // namespace hwmon
+} // namespace phosphor
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sdbusplus/bus.hpp>
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+/** @class PollStatistics
+ *  @brief Timing statistics of the polling loop.
+ *
+ *  Published as the read-only properties of the
+ *  xyz.openbmc_project.Hwmon.PollStatistics interface, all in
+ *  microseconds except for the overrun count:
+ *
+ *  - MaxLateness: latest a poll tick was handled.
+ *  - Overruns: poll ticks skipped because the loop fell behind.
+ *  - MaxCycleTime: longest time from starting to finishing a poll.
+ *  - StaleSensors: sensors still publishing the values restored from
+ *    the restart snapshot, not yet read again.
+ *
+ *  They are signalled with their values when they change, which for
+ *  the maximums is rarely once the loop has settled; the lateness of
+ *  each tick would change with nearly every poll.  A poll's changes
+ *  are signalled together once it finishes.
+ *
+ *  The interface is announced with InterfacesAdded, to the object
+ *  manager of a parent path.
+ */
+class PollStatistics
+{
+    public:
+        PollStatistics() = delete;
+        PollStatistics(const PollStatistics&) = delete;
+        PollStatistics& operator=(const PollStatistics&) = delete;
+        PollStatistics(PollStatistics&&) = delete;
+        PollStatistics& operator=(PollStatistics&&) = delete;
+        ~PollStatistics();
+
+        /** @brief Constructs the statistics and adds them to D-Bus
+         *
+         *  @param[in] bus - D-Bus connection to publish on
+         *  @param[in] path - D-Bus object path to publish at
+         */
+        PollStatistics(sdbusplus::bus::bus& bus, const std::string& path);
+
+        /** @brief Record a poll tick
+         *
+         *  @param[in] lateness - how late the tick was handled
+         *  @param[in] missed - ticks skipped since the last one
+         */
+        void tick(std::chrono::microseconds lateness, uint64_t missed);
+
+        /** @brief Record the time taken by a poll cycle, and signal
+         *         the poll's changes
+         *
+         *  @param[in] time - time from starting to finishing the poll
+         */
+        void cycle(std::chrono::microseconds time);
+
+        /** @brief Record the number of stale sensors
+         *
+         *  @param[in] count - sensors not read since the restart
+         */
+        void stale(uint64_t count);
+
+    private:
+        /** @brief sd-bus property getter for the statistics. */
+        template <uint64_t PollStatistics::*member>
+        static int get(sd_bus* bus, const char* path,
+                       const char* interface, const char* property,
+                       sd_bus_message* reply, void* userData,
+                       sd_bus_error* error);
+
+        /** @brief The statistics' D-Bus interface. */
+        static const sd_bus_vtable vtable[];
+
+        /** @brief Registration of the D-Bus interface. */
+        sd_bus_slot* slot = nullptr;
+
+        /** @brief D-Bus connection, for signals. */
+        sd_bus* bus;
+        /** @brief D-Bus object path. */
+        std::string path;
+
+        /** @brief Properties changed since the last signal, by their
+         *         index in the vtable. */
+        uint8_t changed = 0;
+
+        uint64_t maxLateness = 0;
+        uint64_t overruns = 0;
+        uint64_t maxCycleTime = 0;
+        uint64_t staleSensors = 0;
+};
+
+} // namespace hwmon
+} // namespace phosphor
@@ -0,0 +1,86 @@
+/**
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <phosphor-logging/log.hpp>
+#include <string.h>
+
+#include "propertysignals.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+using namespace phosphor::logging;
+
+void PropertySignals::changed(const std::string& path,
+                              const char* interface,
+                              const char* property)
+{
+    if (!deferred)
+    {
+        char* properties[] = {const_cast<char*>(property), nullptr};
+        emit(path, interface, properties);
+        return;
+    }
+
+    // Changes are reported an object at a time, so only the last
+    // entry can be for the same object and interface.
+    if (!used ||
+        pending[used - 1].path != &path ||
+        pending[used - 1].interface != interface)
+    {
+        if (used == pending.size())
+        {
+            pending.emplace_back();
+        }
+
+        auto& changes = pending[used++];
+        changes.path = &path;
+        changes.interface = interface;
+        changes.properties.clear();
+    }
+
+    pending[used - 1].properties.push_back(const_cast<char*>(property));
+}
+
+void PropertySignals::flush()
+{
+    for (size_t i = 0; i < used; ++i)
+    {
+        auto& changes = pending[i];
+        changes.properties.push_back(nullptr);
+        emit(*changes.path, changes.interface, changes.properties.data());
+    }
+
+    used = 0;
+}
+
+void PropertySignals::emit(const std::string& path,
+                           const char* interface,
+                           char** properties)
+{
+    auto r = sd_bus_emit_properties_changed_strv(
+            bus->get(), path.c_str(), interface, properties);
+    if (r < 0)
+    {
+        // A lost signal is not worth stopping the poll loop for.
+        log<level::ERR>("Failed to emit PropertiesChanged",
+                        entry("PATH=%s", path.c_str()),
+                        entry("INTERFACE=%s", interface),
+                        entry("ERROR=%s", strerror(-r)));
+    }
+}
+
+} // namespace hwmon
+} // namespace phosphor
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sdbusplus/bus.hpp>
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+/** @class PropertySignals
+ *  @brief Emits PropertiesChanged signals for properties set without
+ *         signalling.
+ *
+ *  When deferred, changes are collected until flush(), and the changes
+ *  made to an interface of an object in a row are emitted as a single
+ *  signal.  Otherwise each change is emitted as it is reported.
+ *
+ *  Object paths are held by reference until they are flushed.
+ */
+class PropertySignals
+{
+    public:
+        PropertySignals() = delete;
+        PropertySignals(const PropertySignals&) = delete;
+        PropertySignals& operator=(const PropertySignals&) = delete;
+        PropertySignals(PropertySignals&&) = default;
+        PropertySignals& operator=(PropertySignals&&) = default;
+        ~PropertySignals() = default;
+
+        /** @brief Constructs the signal emitter
+         *
+         *  @param[in] bus - D-Bus connection to emit on
+         */
+        explicit PropertySignals(sdbusplus::bus::bus& bus) : bus(&bus)
+        {
+        }
+
+        /** @brief Enables or disables deferring signals until flush(). */
+        void defer(bool defer)
+        {
+            deferred = defer;
+        }
+
+        /** @brief Report a changed property
+         *
+         *  @param[in] path - the object path
+         *  @param[in] interface - the interface name
+         *  @param[in] property - the property name
+         */
+        void changed(const std::string& path,
+                     const char* interface,
+                     const char* property);
+
+        /** @brief Emit the deferred signals */
+        void flush();
+
+    private:
+        /** @brief Changed properties of an object's interface. */
+        struct Changes
+        {
+            const std::string* path;
+            const char* interface;
+            /** @brief Null terminated list of property names. */
+            std::vector<char*> properties;
+        };
+
+        /** @brief Emit a PropertiesChanged signal */
+        void emit(const std::string& path,
+                  const char* interface,
+                  char** properties);
+
+        /** @brief D-Bus connection. */
+        sdbusplus::bus::bus* bus;
+
+        /** @brief Whether signals are deferred until flush(). */
+        bool deferred = false;
+
+        /** @brief Deferred changes, storage is reused across flushes. */
+        std::vector<Changes> pending;
+
+        /** @brief Number of entries in pending in use. */
+        size_t used = 0;
+};
+
+} // namespace hwmon
+} // namespace phosphor
@@ -13,9 +13,16 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <experimental/filesystem>
+#include <algorithm>
+#include <csignal>
 #include <iostream>
 #include <memory>
+#include <system_error>
+#include <vector>
+#include <sdbusplus/server.hpp>
 #include "argument.hpp"
+#include "env.hpp"
 #include "mainloop.hpp"
 #include "config.h"
 #include "sysfs.hpp"
@@ -28,26 +35,199 @@ static void exit_with_error(const char* err, char** argv)
     exit(-1);
 }
 
+static std::string findHwmon(const std::string& path)
+{
+    // This path may either be a device path (starts with
+    // /devices), or an open firmware device tree path.
+    if (path.substr(0, 8) == "/devices")
+    {
+        return sysfs::findHwmonFromDevPath(path);
+    }
+
+    return sysfs::findHwmonFromOFPath(path);
+}
+
+/** @brief The devices monitored by runDevices(). */
+struct Devices
+{
+    sd_event* event = nullptr;
+    std::vector<std::unique_ptr<MainLoop>> loops;
+    /** @brief Destroys the stopped devices, outside of their handlers. */
+    sd_event_source* reaper = nullptr;
+    /** @brief Exit status, that of the first device that failed. */
+    int status = 0;
+};
+
+/**
+ * Destroys the devices that stopped, and exits once none are left.
+ */
+static int reap(sd_event_source*, void* data)
+{
+    auto devices = static_cast<Devices*>(data);
+    auto& loops = devices->loops;
+
+    for (auto& loop : loops)
+    {
+        if (loop->stopped() && !devices->status)
+        {
+            devices->status = loop->status();
+        }
+    }
+    loops.erase(std::remove_if(loops.begin(), loops.end(),
+                               [](const auto& loop)
+                               {
+                                   return loop->stopped();
+                               }),
+                loops.end());
+
+    if (loops.empty())
+    {
+        sd_event_exit(devices->event, devices->status);
+    }
+    return 0;
+}
+
+/**
+ * Monitors every device with an environment file in a directory,
+ * sharing one bus connection, object managers and event loop.
+ *
+ * Each <dir>/<device path>.conf file holds the settings of the device
+ * at <device path>, the same layout used to start a daemon per device.
+ * A device that fails or goes away stops on its own, the process exits
+ * once all of them have.
+ */
+static int runDevices(std::string dir)
+{
+    namespace fs = std::experimental::filesystem;
+    static constexpr auto suffix = ".conf";
+
+    while (dir.size() > 1 && dir.back() == '/')
+    {
+        dir.pop_back();
+    }
+
+    auto bus = sdbusplus::bus::new_default();
+    sdbusplus::server::manager::manager manager(bus, SENSOR_ROOT);
+    sdbusplus::server::manager::manager statsManager(bus, stats_root);
+    Devices devices;
+    sd_event_default(&devices.event);
+    auto event = devices.event;
+    sd_event_add_defer(event, &devices.reaper, reap, &devices);
+    sd_event_source_set_enabled(devices.reaper, SD_EVENT_OFF);
+    auto stopped = [&devices]()
+    {
+        sd_event_source_set_enabled(devices.reaper, SD_EVENT_ONESHOT);
+    };
+
+    // Block SIGHUP before the read threads start, so only the
+    // event loop sees it.
+    sigset_t hangup;
+    sigemptyset(&hangup);
+    sigaddset(&hangup, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &hangup, nullptr);
+
+    auto& loops = devices.loops;
+    for (auto& file : fs::recursive_directory_iterator(dir))
+    {
+        auto conf = file.path();
+        if (!fs::is_regular_file(conf) || conf.extension() != suffix)
+        {
+            continue;
+        }
+
+        auto param = conf.string().substr(dir.size());
+        param.erase(param.size() - std::string(suffix).size());
+
+        auto path = findHwmon(param);
+        if (path.empty())
+        {
+            // Not every configured device is present.
+            continue;
+        }
+
+        auto calloutPath = sysfs::findCalloutPath(path);
+        if (calloutPath.empty())
+        {
+            std::cerr << "Unable to determine callout path for "
+                      << param << std::endl;
+            continue;
+        }
+
+        auto loop = std::make_unique<MainLoop>(
+            bus,
+            param,
+            path,
+            calloutPath,
+            BUSNAME_PREFIX,
+            SENSOR_ROOT,
+            env::loadSettings(conf.string()));
+        auto status = EXIT_FAILURE;
+        try
+        {
+            if (loop->start(event, stopped))
+            {
+                loops.push_back(std::move(loop));
+                continue;
+            }
+            status = loop->status();
+        }
+        catch (const std::system_error& e)
+        {
+            // Only this device goes without monitoring.
+            std::cerr << "Unable to start monitoring " << param << ": "
+                      << e.what() << std::endl;
+        }
+
+        if (!devices.status)
+        {
+            devices.status = status;
+        }
+    }
+
+    if (loops.empty())
+    {
+        sd_event_source_unref(devices.reaper);
+        return devices.status;
+    }
+
+    sd_event_add_signal(
+            event, nullptr, SIGHUP,
+            [](sd_event_source*, const struct signalfd_siginfo*, void* data)
+            {
+                for (auto& loop : static_cast<Devices*>(data)->loops)
+                {
+                    loop->reload();
+                }
+                return 0;
+            },
+            &devices);
+
+    bus.attach_event(event, SD_EVENT_PRIORITY_IMPORTANT);
+    auto rc = sd_event_loop(event);
+
+    loops.clear();
+    sd_event_source_unref(devices.reaper);
+    return rc;
+}
+
 int main(int argc, char** argv)
 {
     // Read arguments.
     auto options = std::make_unique<ArgumentParser>(argc, argv);
 
+    auto configDir = (*options)["config-dir"];
+    if (configDir != ArgumentParser::empty_string)
+    {
+        options.reset();
+        return runDevices(configDir);
+    }
+
     // Parse out path argument.
     auto path = (*options)["dev-path"];
     auto param = path;
     if (path != ArgumentParser::empty_string)
     {
-        // This path may either be a device path (starts with
-        // /devices), or an open firmware device tree path.
-        if (path.substr(0, 8) == "/devices")
-        {
-            path = sysfs::findHwmonFromDevPath(path);
-        }
-        else
-        {
-            path = sysfs::findHwmonFromOFPath(path);
-        }
+        path = findHwmon(path);
     }
 
     if (path == ArgumentParser::empty_string)
@@ -78,9 +258,8 @@ int main(int argc, char** argv)
         calloutPath,
         BUSNAME_PREFIX,
         SENSOR_ROOT);
-    loop.run();
 
-    return 0;
+    return loop.run();
 }
 
 // vim: tabstop=8 expandtab shiftwidth=4 softtabstop=4
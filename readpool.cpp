@@ -0,0 +1,241 @@
+/**
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <system_error>
+#include <unistd.h>
+
+#include "readpool.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+ReadPool::ReadPool(sd_event* event,
+                   const hwmonio::HwmonIOInterface& io,
+                   size_t threads,
+                   std::function<void()> callback) :
+    io(io),
+    callback(callback),
+    efd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    if (!efd)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "eventfd");
+    }
+
+    auto r = sd_event_add_io(event, &eventSource, efd(), EPOLLIN,
+                             completionHandler, this);
+    if (r < 0)
+    {
+        throw std::system_error(-r, std::generic_category(), strerror(-r));
+    }
+
+    for (size_t i = 0; i < threads; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+
+    // Start the threads once the workers can no longer move.
+    for (size_t i = 0; i < threads; ++i)
+    {
+        auto& worker = *workers[i];
+        worker.thread = std::thread(&ReadPool::work, this,
+                                    std::ref(worker), i);
+    }
+}
+
+ReadPool::~ReadPool()
+{
+    {
+        std::lock_guard<std::mutex> l(lock);
+        stop = true;
+    }
+    cv.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker->thread.join();
+    }
+
+    if (eventSource)
+    {
+        eventSource = sd_event_source_unref(eventSource);
+    }
+}
+
+bool ReadPool::submit(const std::vector<Attribute>& attributes,
+                      std::vector<int64_t>& values,
+                      std::vector<int>& errors)
+{
+    if (busy())
+    {
+        return false;
+    }
+
+    values.resize(attributes.size());
+    errors.resize(attributes.size());
+    outstanding = workers.size();
+
+    {
+        std::lock_guard<std::mutex> l(lock);
+        this->attributes = &attributes;
+        this->values = &values;
+        this->errors = &errors;
+        ++generation;
+    }
+    cv.notify_all();
+
+    return true;
+}
+
+void ReadPool::readAll(const hwmonio::HwmonIOInterface& io,
+                       size_t threads,
+                       const std::vector<Attribute>& attributes,
+                       std::vector<int64_t>& values,
+                       std::vector<int>& errors)
+{
+    auto size = attributes.size();
+    threads = std::max<size_t>(1, std::min(threads, size));
+    if (threads == 1)
+    {
+        io.readBatch(attributes, values, errors);
+        return;
+    }
+
+    values.resize(size);
+    errors.resize(size);
+
+    auto chunk = (size + threads - 1) / threads;
+    std::vector<std::thread> readers;
+    for (size_t begin = 0; begin < size; begin += chunk)
+    {
+        auto end = std::min(size, begin + chunk);
+        readers.emplace_back([&, begin, end]()
+        {
+            std::vector<Attribute> chunkAttributes(
+                    attributes.begin() + begin, attributes.begin() + end);
+            std::vector<int64_t> chunkValues;
+            std::vector<int> chunkErrors;
+
+            io.readBatch(chunkAttributes, chunkValues, chunkErrors);
+
+            std::copy(chunkValues.begin(), chunkValues.end(),
+                      values.begin() + begin);
+            std::copy(chunkErrors.begin(), chunkErrors.end(),
+                      errors.begin() + begin);
+        });
+    }
+
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+}
+
+void ReadPool::work(Worker& worker, size_t index)
+{
+    uint64_t seen = 0;
+
+    while (true)
+    {
+        size_t begin;
+        size_t end;
+
+        {
+            std::unique_lock<std::mutex> l(lock);
+            cv.wait(l, [&]() { return stop || generation != seen; });
+            if (stop)
+            {
+                return;
+            }
+            seen = generation;
+
+            auto size = attributes->size();
+            auto chunk = (size + workers.size() - 1) / workers.size();
+            begin = std::min(size, index * chunk);
+            end = std::min(size, begin + chunk);
+        }
+
+        if (begin != end)
+        {
+            worker.attributes.assign(attributes->begin() + begin,
+                                     attributes->begin() + end);
+            io.readBatch(worker.attributes, worker.values, worker.errors);
+
+            std::copy(worker.values.begin(), worker.values.end(),
+                      values->begin() + begin);
+            std::copy(worker.errors.begin(), worker.errors.end(),
+                      errors->begin() + begin);
+        }
+
+        push(&worker);
+
+        uint64_t one = 1;
+        while (::write(efd(), &one, sizeof(one)) < 0 && errno == EINTR)
+        {
+        }
+    }
+}
+
+void ReadPool::push(Worker* worker)
+{
+    worker->next = finished.load(std::memory_order_relaxed);
+    while (!finished.compare_exchange_weak(worker->next, worker,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed))
+    {
+    }
+}
+
+ReadPool::Worker* ReadPool::drain()
+{
+    return finished.exchange(nullptr, std::memory_order_acquire);
+}
+
+int ReadPool::completionHandler(sd_event_source* eventSource,
+                                int fd, uint32_t revents,
+                                void* userData)
+{
+    auto pool = static_cast<ReadPool*>(userData);
+
+    uint64_t count;
+    while (::read(fd, &count, sizeof(count)) < 0 && errno == EINTR)
+    {
+    }
+
+    auto done = false;
+    for (auto worker = pool->drain(); worker; worker = worker->next)
+    {
+        if (pool->outstanding && --pool->outstanding == 0)
+        {
+            done = true;
+        }
+    }
+
+    if (done && pool->callback)
+    {
+        pool->callback();
+    }
+
+    return 0;
+}
+
+} // namespace hwmon
+} // namespace phosphor
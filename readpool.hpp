@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <systemd/sd-event.h>
+
+#include "hwmonio.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+/** @class ReadPool
+ *  @brief Performs batch reads on a pool of reader threads.
+ *
+ *  A submitted batch is split into one contiguous chunk per thread,
+ *  and each thread reads its chunk with the blocking
+ *  HwmonIOInterface::readBatch.  Finished chunks are handed back
+ *  through a lock-free queue and an eventfd watched by the sd_event
+ *  loop, and the completion callback runs on the event loop thread
+ *  once every chunk is done, so it is free to update D-Bus objects.
+ */
+class ReadPool
+{
+    public:
+        using Attribute = hwmonio::HwmonIOInterface::Attribute;
+
+        ReadPool() = delete;
+        ReadPool(const ReadPool&) = delete;
+        ReadPool& operator=(const ReadPool&) = delete;
+        ReadPool(ReadPool&&) = delete;
+        ReadPool& operator=(ReadPool&&) = delete;
+        ~ReadPool();
+
+        /** @brief Constructs the pool and starts its threads
+         *
+         *  @param[in] event - sd_event loop to complete batches on
+         *  @param[in] io - hwmon sysfs access used by the threads
+         *  @param[in] threads - number of reader threads
+         *  @param[in] callback - called when a batch is complete
+         */
+        ReadPool(sd_event* event,
+                 const hwmonio::HwmonIOInterface& io,
+                 size_t threads,
+                 std::function<void()> callback);
+
+        /** @brief Start reading a batch on the pool
+         *
+         *  The vectors must not be accessed until the completion
+         *  callback runs.
+         *
+         *  @param[in] attributes - the attributes to read
+         *  @param[out] values - the read values
+         *  @param[out] errors - the errno of each read
+         *
+         *  @return false if a batch is already in flight
+         */
+        bool submit(const std::vector<Attribute>& attributes,
+                    std::vector<int64_t>& values,
+                    std::vector<int>& errors);
+
+        /** @brief Read a batch on temporary threads and wait for it
+         *
+         *  For reads before the event loop runs, such as the initial
+         *  reads of every sensor, where waiting is all there is to do.
+         *
+         *  @param[in] io - hwmon sysfs access used by the threads
+         *  @param[in] threads - most reader threads to use
+         *  @param[in] attributes - the attributes to read
+         *  @param[out] values - the read values
+         *  @param[out] errors - the errno of each read
+         */
+        static void readAll(const hwmonio::HwmonIOInterface& io,
+                            size_t threads,
+                            const std::vector<Attribute>& attributes,
+                            std::vector<int64_t>& values,
+                            std::vector<int>& errors);
+
+        /** @brief Check if a batch is in flight */
+        bool busy() const
+        {
+            return outstanding != 0;
+        }
+
+        /** @brief eventfd expiry handler - completes batches
+         *
+         *  @param[in] eventSource - Source of the event
+         *  @param[in] fd - The eventfd
+         *  @param[in] revents - The received events
+         *  @param[in] userData - User data pointer
+         */
+        static int completionHandler(sd_event_source* eventSource,
+                                     int fd, uint32_t revents,
+                                     void* userData);
+
+    private:
+        /** @brief A reader thread and its chunk of the batch. */
+        struct Worker
+        {
+            std::thread thread;
+            std::vector<Attribute> attributes;
+            std::vector<int64_t> values;
+            std::vector<int> errors;
+            /** @brief Next finished worker in the completion queue. */
+            Worker* next = nullptr;
+        };
+
+        /** @brief Reader thread main loop. */
+        void work(Worker& worker, size_t index);
+
+        /** @brief Queue a finished worker, from any thread. */
+        void push(Worker* worker);
+
+        /** @brief Take all finished workers, from the event loop. */
+        Worker* drain();
+
+        /** @brief Hwmon sysfs access. */
+        const hwmonio::HwmonIOInterface& io;
+
+        /** @brief Batch completion callback. */
+        std::function<void()> callback;
+
+        /** @brief The reader threads. */
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        /** @brief Protects the batch handed to the threads. */
+        std::mutex lock;
+
+        /** @brief Wakes the threads for a new batch or to stop. */
+        std::condition_variable cv;
+
+        /** @brief Incremented for every submitted batch. */
+        uint64_t generation = 0;
+
+        /** @brief Tells the threads to exit. */
+        bool stop = false;
+
+        /** @brief The batch in flight. */
+        const std::vector<Attribute>* attributes = nullptr;
+        std::vector<int64_t>* values = nullptr;
+        std::vector<int>* errors = nullptr;
+
+        /** @brief Lock-free stack of finished workers. */
+        std::atomic<Worker*> finished{nullptr};
+
+        /** @brief Chunks of the batch in flight not yet complete. */
+        size_t outstanding = 0;
+
+        /** @brief Signals the event loop that workers finished. */
+        hwmonio::FileDescriptor efd;
+
+        /** @brief Source of events */
+        sd_event_source* eventSource = nullptr;
+};
+
+} // namespace hwmon
+} // namespace phosphor
@@ -8,7 +8,6 @@
 #include "sensor.hpp"
 #include "sensorset.hpp"
 #include "hwmon.hpp"
-#include "env.hpp"
 #include "sysfs.hpp"
 
 namespace sensor
@@ -18,55 +17,29 @@ using namespace phosphor::logging;
 
 Sensor::Sensor(const SensorSet::key_type& sensor,
                const hwmonio::HwmonIO& ioAccess,
-               const std::string& devPath) :
+               const std::string& devPath,
+               const config::Sensor& config) :
     sensor(sensor),
     ioAccess(ioAccess),
     devPath(devPath)
 {
-    auto gain = env::getEnv("GAIN", sensor);
-    if (!gain.empty())
-    {
-        sensorAdjusts.gain = std::stod(gain);
-    }
+    reconfigure(config);
+}
 
-    auto offset = env::getEnv("OFFSET", sensor);
-    if (!offset.empty())
-    {
-        sensorAdjusts.offset = std::stoi(offset);
-    }
-    auto senRmRCs = env::getEnv("REMOVERCS", sensor);
+void Sensor::reconfigure(const config::Sensor& config)
+{
+    this->config = config;
+
+    sensorAdjusts = valueAdjust();
+    sensorAdjusts.gain = config.gain;
+    sensorAdjusts.offset = config.offset;
     // Add sensor removal return codes defined per sensor
-    addRemoveRCs(senRmRCs);
+    addRemoveRCs(config.removeRCs);
 }
 
-void Sensor::addRemoveRCs(const std::string& rcList)
+void Sensor::addRemoveRCs(const std::unordered_set<int>& rcList)
 {
-    if (rcList.empty())
-    {
-        return;
-    }
-
-    // Convert to a char* for strtok
-    std::vector<char> rmRCs(rcList.c_str(),
-                            rcList.c_str() + rcList.size() + 1);
-    auto rmRC = std::strtok(&rmRCs[0], ", ");
-    while (rmRC != nullptr)
-    {
-        try
-        {
-            sensorAdjusts.rmRCs.insert(std::stoi(rmRC));
-        }
-        catch (const std::logic_error& le)
-        {
-            // Unable to convert to int, continue to next token
-            std::string name = sensor.first + "_" + sensor.second;
-            log<level::INFO>("Unable to convert sensor removal return code",
-                             entry("SENSOR=%s", name.c_str()),
-                             entry("RC=%s", rmRC),
-                             entry("EXCEPTION=%s", le.what()));
-        }
-        rmRC = std::strtok(nullptr, ", ");
-    }
+    sensorAdjusts.rmRCs.insert(rcList.begin(), rcList.end());
 }
 
 int64_t Sensor::adjustValue(int64_t value)
@@ -91,7 +64,8 @@ int64_t Sensor::adjustValue(int64_t value)
 
 std::shared_ptr<ValueObject> Sensor::addValue(
         const RetryIO& retryIO,
-        ObjectInfo& info)
+        ObjectInfo& info,
+        std::experimental::optional<int64_t> initial)
 {
     static constexpr bool deferSignals = true;
 
@@ -111,7 +85,11 @@ std::shared_ptr<ValueObject> Sensor::addValue(
 
     // If there's no fault file or the sensor has a fault file and
     // its status is functional, read the input value.
-    if (!statusIface || (statusIface && statusIface->functional()))
+    if (initial)
+    {
+        val = *initial;
+    }
+    else if (!statusIface || (statusIface && statusIface->functional()))
     {
         // Retry for up to a second if device is busy
         // or has a transient error.
@@ -134,22 +112,22 @@ std::shared_ptr<ValueObject> Sensor::addValue(
         iface->scale(hwmon::getScale(attrs));
     }
 
-    auto maxValue = env::getEnv("MAXVALUE", sensor);
-    if(!maxValue.empty())
+    if (config.maxValue)
     {
-        iface->maxValue(std::stoll(maxValue));
+        iface->maxValue(*config.maxValue);
     }
-    auto minValue = env::getEnv("MINVALUE", sensor);
-    if(!minValue.empty())
+    if (config.minValue)
     {
-        iface->minValue(std::stoll(minValue));
+        iface->minValue(*config.minValue);
     }
 
     obj[InterfaceType::VALUE] = iface;
     return iface;
 }
 
-std::shared_ptr<StatusObject> Sensor::addStatus(ObjectInfo& info)
+std::shared_ptr<StatusObject> Sensor::addStatus(
+        ObjectInfo& info,
+        std::experimental::optional<bool> initial)
 {
     namespace fs = std::experimental::filesystem;
 
@@ -174,11 +152,19 @@ std::shared_ptr<StatusObject> Sensor::addStatus(ObjectInfo& info)
         uint32_t fault = 0;
         try
         {
-            fault = ioAccess.read(faultName,
-                                  faultID,
-                                  entry,
-                                  hwmonio::retries,
-                                  hwmonio::delay);
+            if (initial)
+            {
+                fault = !*initial;
+            }
+            else
+            {
+                fault = ioAccess.read(faultName,
+                                      faultID,
+                                      entry,
+                                      hwmonio::retries,
+                                      hwmonio::delay);
+            }
+
             if (fault != 0)
             {
                 functional = false;
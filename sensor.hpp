@@ -1,9 +1,11 @@
 #pragma once
 
+#include <experimental/optional>
 #include <unordered_set>
 #include "types.hpp"
 #include "sensorset.hpp"
 #include "hwmonio.hpp"
+#include "sensorconfig.hpp"
 
 namespace sensor
 {
@@ -37,10 +39,12 @@ class Sensor
          * @param[in] sensor - A pair of sensor indentifiers
          * @param[in] ioAccess - Hwmon sysfs access
          * @param[in] devPath - Device sysfs path
+         * @param[in] config - The sensor's settings
          */
         explicit Sensor(const SensorSet::key_type& sensor,
                         const hwmonio::HwmonIO& ioAccess,
-                        const std::string& devPath);
+                        const std::string& devPath,
+                        const config::Sensor& config);
 
         /**
          * @brief Adds any sensor removal return codes for the sensor
@@ -49,7 +53,16 @@ class Sensor
          *
          * @param[in] rcList - List of return codes found for the sensor
          */
-        void addRemoveRCs(const std::string& rcList);
+        void addRemoveRCs(const std::unordered_set<int>& rcList);
+
+        /**
+         * @brief Replaces the sensor's settings
+         * @details Resets the adjustments to those of the new settings,
+         * any device level removal return codes must be added again.
+         *
+         * @param[in] config - The sensor's new settings
+         */
+        void reconfigure(const config::Sensor& config);
 
         /**
          * @brief Get the adjustments struct for the sensor
@@ -81,12 +94,15 @@ class Sensor
          * @param[in] retryIO - Hwmon sysfs file retry constraints
          *                      (number of and delay between)
          * @param[in] info - Sensor object information
+         * @param[in] initial - Adjusted value to use instead of reading
+         *                      the input file, if any
          *
          * @return - Shared pointer to the value object
          */
         std::shared_ptr<ValueObject> addValue(
                 const RetryIO& retryIO,
-                ObjectInfo& info);
+                ObjectInfo& info,
+                std::experimental::optional<int64_t> initial = {});
 
         /**
          * @brief Add status interface and functional property for sensor
@@ -96,11 +112,14 @@ class Sensor
          * fault file.
          *
          * @param[in] info - Sensor object information
+         * @param[in] initial - Functional value to use instead of
+         *                      reading the fault file, if any
          *
          * @return - Shared pointer to the status object
          */
         std::shared_ptr<StatusObject> addStatus(
-                ObjectInfo& info);
+                ObjectInfo& info,
+                std::experimental::optional<bool> initial = {});
 
     private:
         /** @brief Sensor object's identifiers */
@@ -112,6 +131,9 @@ class Sensor
         /** @brief Physical device sysfs path. */
         const std::string& devPath;
 
+        /** @brief The sensor's settings. */
+        config::Sensor config;
+
         /** @brief Structure for storing sensor adjustments */
         valueAdjust sensorAdjusts;
 };
@@ -0,0 +1,485 @@
+/**
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <phosphor-logging/log.hpp>
+
+#include "config.h"
+#include "sensorconfig.hpp"
+
+#ifdef ENABLE_CONFIG_FILE
+#include <nlohmann/json.hpp>
+#endif
+
+namespace config
+{
+
+using namespace phosphor::logging;
+
+namespace
+{
+
+bool toInt(const std::string& value, int64_t& result)
+{
+    char* end = nullptr;
+    errno = 0;
+    auto v = std::strtoll(value.c_str(), &end, 10);
+    if (end == value.c_str() || *end || errno == ERANGE)
+    {
+        return false;
+    }
+    result = v;
+    return true;
+}
+
+bool toUInt(const std::string& value, uint64_t& result)
+{
+    char* end = nullptr;
+    errno = 0;
+    auto v = std::strtoull(value.c_str(), &end, 10);
+    if (end == value.c_str() || *end || errno == ERANGE || value[0] == '-')
+    {
+        return false;
+    }
+    result = v;
+    return true;
+}
+
+template <typename T>
+bool toInt(const std::string& value, optional<T>& result)
+{
+    int64_t v;
+    if (!toInt(value, v))
+    {
+        return false;
+    }
+    result = v;
+    return true;
+}
+
+template <typename T>
+bool toUInt(const std::string& value, optional<T>& result)
+{
+    uint64_t v;
+    if (!toUInt(value, v))
+    {
+        return false;
+    }
+    result = v;
+    return true;
+}
+
+bool toHysteresis(const std::string& value, optional<int64_t>& result)
+{
+    int64_t v;
+    if (!toInt(value, v) || v < 0)
+    {
+        return false;
+    }
+    result = v;
+    return true;
+}
+
+bool toDebounce(const std::string& value, optional<hwmon::Debounce>& result)
+{
+    hwmon::Debounce debounce;
+    if (!hwmon::Debounce::parse(value, debounce))
+    {
+        return false;
+    }
+    result = debounce;
+    return true;
+}
+
+bool toDeadband(const std::string& value, optional<hwmon::Deadband>& result)
+{
+    char* end = nullptr;
+    auto band = std::strtod(value.c_str(), &end);
+    if (end == value.c_str() || band < 0 || (*end && strcmp(end, "%")))
+    {
+        return false;
+    }
+    result = hwmon::Deadband::parse(value);
+    return true;
+}
+
+bool toHistory(const std::string& value, optional<size_t>& result)
+{
+    uint64_t v;
+    if (!toUInt(value, v) || v > phosphor::hwmon::History::max_capacity)
+    {
+        return false;
+    }
+    result = v;
+    return true;
+}
+
+/** @brief Parse a comma or space separated list of window lengths. */
+bool toWindows(const std::string& value, std::vector<size_t>& result)
+{
+    std::vector<size_t> windows;
+    std::vector<char> list(value.c_str(), value.c_str() + value.size() + 1);
+    auto window = std::strtok(&list[0], ", ");
+    while (window != nullptr)
+    {
+        uint64_t v;
+        if (!toUInt(window, v) || !v ||
+            v > phosphor::hwmon::History::max_capacity)
+        {
+            return false;
+        }
+        windows.push_back(v);
+        window = std::strtok(nullptr, ", ");
+    }
+    result = std::move(windows);
+    return true;
+}
+
+/** @brief Parse a comma or space separated return code list. */
+bool toRCs(const std::string& value, std::unordered_set<int>& result)
+{
+    auto valid = true;
+    std::vector<char> rcs(value.c_str(), value.c_str() + value.size() + 1);
+    auto rc = std::strtok(&rcs[0], ", ");
+    while (rc != nullptr)
+    {
+        int64_t v;
+        if (toInt(rc, v) && v >= INT_MIN && v <= INT_MAX)
+        {
+            result.insert(static_cast<int>(v));
+        }
+        else
+        {
+            valid = false;
+        }
+        rc = std::strtok(nullptr, ", ");
+    }
+    return valid;
+}
+
+bool toSwitch(const std::string& value, bool& result)
+{
+    result = value != "0";
+    return true;
+}
+
+using SensorParser = bool (*)(const std::string&, Sensor&);
+using DeviceParser = bool (*)(const std::string&, Device&);
+
+const std::pair<const char*, SensorParser> sensorSettings[] =
+{
+    {"MODE", [](const std::string& v, Sensor& s)
+        { s.mode = v; return true; }},
+    {"LABEL", [](const std::string& v, Sensor& s)
+        { s.label = v; return true; }},
+    {"GAIN", [](const std::string& v, Sensor& s)
+        {
+            char* end = nullptr;
+            auto gain = std::strtod(v.c_str(), &end);
+            if (end == v.c_str() || *end)
+            {
+                return false;
+            }
+            s.gain = gain;
+            return true;
+        }},
+    {"OFFSET", [](const std::string& v, Sensor& s)
+        {
+            int64_t offset;
+            if (!toInt(v, offset) || offset < INT_MIN || offset > INT_MAX)
+            {
+                return false;
+            }
+            s.offset = static_cast<int>(offset);
+            return true;
+        }},
+    {"REMOVERCS", [](const std::string& v, Sensor& s)
+        { return toRCs(v, s.removeRCs); }},
+    {"MAXVALUE", [](const std::string& v, Sensor& s)
+        { return toInt(v, s.maxValue); }},
+    {"MINVALUE", [](const std::string& v, Sensor& s)
+        { return toInt(v, s.minValue); }},
+    {"WARNLO", [](const std::string& v, Sensor& s)
+        { return toInt(v, s.warnLo); }},
+    {"WARNHI", [](const std::string& v, Sensor& s)
+        { return toInt(v, s.warnHi); }},
+    {"CRITLO", [](const std::string& v, Sensor& s)
+        { return toInt(v, s.critLo); }},
+    {"CRITHI", [](const std::string& v, Sensor& s)
+        { return toInt(v, s.critHi); }},
+    {"WARNHYST", [](const std::string& v, Sensor& s)
+        { return toHysteresis(v, s.warnHyst); }},
+    {"CRITHYST", [](const std::string& v, Sensor& s)
+        { return toHysteresis(v, s.critHyst); }},
+    {"DEBOUNCE", [](const std::string& v, Sensor& s)
+        { return toDebounce(v, s.debounce); }},
+    {"PWM_TARGET", [](const std::string& v, Sensor& s)
+        { s.pwmTarget = v; return true; }},
+    {"ENABLE", [](const std::string& v, Sensor& s)
+        { return toUInt(v, s.enable); }},
+    {"INTERVAL", [](const std::string& v, Sensor& s)
+        { return toUInt(v, s.interval); }},
+    {"DEADBAND", [](const std::string& v, Sensor& s)
+        { return toDeadband(v, s.deadband); }},
+    {"HEARTBEAT", [](const std::string& v, Sensor& s)
+        { return toUInt(v, s.heartbeat); }},
+    {"HISTORY", [](const std::string& v, Sensor& s)
+        { return toHistory(v, s.history); }},
+};
+
+const std::pair<const char*, DeviceParser> deviceSettings[] =
+{
+    {"REMOVERCS", [](const std::string& v, Device& d)
+        { return toRCs(v, d.removeRCs); }},
+    {"INTERVAL", [](const std::string& v, Device& d)
+        { return toUInt(v, d.interval); }},
+    {"UPDATE_INTERVAL", [](const std::string& v, Device& d)
+        { return toUInt(v, d.updateInterval); }},
+    {"TARGET_MODE", [](const std::string& v, Device& d)
+        {
+            std::string mode{v};
+            std::transform(mode.begin(), mode.end(), mode.begin(), toupper);
+            if (mode == RPM_TARGET)
+            {
+                d.targetMode = targetType::RPM;
+            }
+            else if (mode == PWM_TARGET)
+            {
+                d.targetMode = targetType::PWM;
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        }},
+    {"DEADBAND", [](const std::string& v, Device& d)
+        { return toDeadband(v, d.deadband); }},
+    {"DEBOUNCE", [](const std::string& v, Device& d)
+        { return toDebounce(v, d.debounce); }},
+    {"HEARTBEAT", [](const std::string& v, Device& d)
+        { return toUInt(v, d.heartbeat); }},
+    {"HISTORY", [](const std::string& v, Device& d)
+        { return toHistory(v, d.history); }},
+    {"STAT_WINDOWS", [](const std::string& v, Device& d)
+        { return toWindows(v, d.statWindows); }},
+    {"COALESCE_SIGNALS", [](const std::string& v, Device& d)
+        { return toSwitch(v, d.coalesceSignals); }},
+    {"ALARM_EVENTS", [](const std::string& v, Device& d)
+        { return toSwitch(v, d.alarmEvents); }},
+    {"CHIP_THRESHOLDS", [](const std::string& v, Device& d)
+        { return toSwitch(v, d.chipThresholds); }},
+    {"SENSOR_TABLE", [](const std::string& v, Device& d)
+        { return toSwitch(v, d.sensorTable); }},
+    {"SNAPSHOT_INTERVAL", [](const std::string& v, Device& d)
+        { return toUInt(v, d.snapshotInterval); }},
+    {"SNAPSHOT_MAX_AGE", [](const std::string& v, Device& d)
+        { return toUInt(v, d.snapshotMaxAge); }},
+    {"READ_THREADS", [](const std::string& v, Device& d)
+        {
+            uint64_t threads;
+            if (!toUInt(v, threads))
+            {
+                return false;
+            }
+            d.readThreads = threads;
+            return true;
+        }},
+};
+
+#ifdef ENABLE_CONFIG_FILE
+/** @brief Convert a JSON setting to its environment form. */
+bool toSetting(const nlohmann::json& value, std::string& setting)
+{
+    if (value.is_string())
+    {
+        setting = value.get<std::string>();
+    }
+    else if (value.is_boolean())
+    {
+        setting = value.get<bool>() ? "1" : "0";
+    }
+    else if (value.is_number())
+    {
+        setting = value.dump();
+    }
+    else if (value.is_array())
+    {
+        setting.clear();
+        for (const auto& v : value)
+        {
+            std::string element;
+            if (!v.is_number() && !v.is_string())
+            {
+                return false;
+            }
+            toSetting(v, element);
+            setting += (setting.empty() ? "" : ",") + element;
+        }
+    }
+    else if (value.is_null())
+    {
+        setting.clear();
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+const Sensor& Device::sensor(const std::string& type,
+                             const std::string& id) const
+{
+    static const Sensor defaults;
+
+    auto s = sensors.find(type + id);
+    return (s != sensors.end()) ? s->second : defaults;
+}
+
+Device parse(const env::Settings& settings)
+{
+    Device device;
+
+    for (const auto& setting : settings)
+    {
+        const auto& key = setting.first;
+        const auto& value = setting.second;
+
+        // Empty settings are the same as unset ones.
+        if (value.empty())
+        {
+            continue;
+        }
+
+        auto valid = true;
+        for (const auto& d : deviceSettings)
+        {
+            if (key == d.first)
+            {
+                valid = d.second(value, device);
+                break;
+            }
+        }
+
+        for (const auto& s : sensorSettings)
+        {
+            auto len = strlen(s.first);
+            if (key.size() > len + 1 &&
+                key.compare(0, len, s.first) == 0 &&
+                key[len] == '_')
+            {
+                valid = s.second(value, device.sensors[key.substr(len + 1)]);
+                break;
+            }
+        }
+
+        if (!valid)
+        {
+            device.errors.push_back(key + '=' + value);
+        }
+    }
+
+    return device;
+}
+
+#ifdef ENABLE_CONFIG_FILE
+bool loadJson(const std::string& path, env::Settings& settings)
+{
+    std::ifstream handle(path.c_str());
+    if (handle.fail())
+    {
+        return false;
+    }
+
+    auto file = nlohmann::json::parse(handle, nullptr, false);
+    if (file.is_discarded() || !file.is_object())
+    {
+        return false;
+    }
+
+    auto valid = true;
+    for (auto item = file.begin(); item != file.end(); ++item)
+    {
+        if (item.key() != "sensors")
+        {
+            valid = toSetting(item.value(), settings[item.key()]) && valid;
+            continue;
+        }
+
+        if (!item->is_object())
+        {
+            valid = false;
+            continue;
+        }
+
+        for (auto sensor = item->begin(); sensor != item->end(); ++sensor)
+        {
+            if (!sensor->is_object())
+            {
+                valid = false;
+                continue;
+            }
+
+            for (auto s = sensor->begin(); s != sensor->end(); ++s)
+            {
+                auto key = s.key() + '_' + sensor.key();
+                valid = toSetting(s.value(), settings[key]) && valid;
+            }
+        }
+    }
+
+    return valid;
+}
+#endif
+
+Device load()
+{
+    auto settings = env::getAll();
+
+    auto file = settings.find("CONFIG_FILE");
+    if (file != settings.end() && !file->second.empty())
+    {
+        auto path = file->second;
+#ifdef ENABLE_CONFIG_FILE
+        if (!loadJson(path, settings))
+        {
+            log<level::ERR>("Unable to load all of the config file",
+                    entry("FILE=%s", path.c_str()));
+        }
+#else
+        log<level::ERR>("Config files aren't supported by this build",
+                entry("FILE=%s", path.c_str()));
+#endif
+    }
+
+    auto device = parse(settings);
+
+    for (const auto& e : device.errors)
+    {
+        log<level::ERR>("Ignoring invalid setting",
+                entry("SETTING=%s", e.c_str()));
+    }
+
+    return device;
+}
+
+} // namespace config
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstdint>
+#include <experimental/optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "deadband.hpp"
+#include "debounce.hpp"
+#include "env.hpp"
+#include "history.hpp"
+#include "sensorset.hpp"
+
+enum class targetType
+{
+    DEFAULT,
+    RPM,
+    PWM
+};
+
+static constexpr auto RPM_TARGET = "RPM";
+static constexpr auto PWM_TARGET = "PWM";
+
+namespace config
+{
+
+template <typename T>
+using optional = std::experimental::optional<T>;
+
+/** @brief Settings of a single sensor, from <SETTING>_<type><id>. */
+struct Sensor
+{
+    /** @brief MODE, the file suffix to read the sensor's id from. */
+    std::string mode;
+    /** @brief LABEL, the object name, keyed by the (indirect) id. */
+    std::string label;
+    /** @brief GAIN */
+    double gain = 1.0;
+    /** @brief OFFSET */
+    int offset = 0;
+    /** @brief REMOVERCS */
+    std::unordered_set<int> removeRCs;
+    /** @brief MAXVALUE */
+    optional<int64_t> maxValue;
+    /** @brief MINVALUE */
+    optional<int64_t> minValue;
+    /** @brief WARNLO, keyed by the (indirect) id. */
+    optional<int64_t> warnLo;
+    /** @brief WARNHI, keyed by the (indirect) id. */
+    optional<int64_t> warnHi;
+    /** @brief CRITLO, keyed by the (indirect) id. */
+    optional<int64_t> critLo;
+    /** @brief CRITHI, keyed by the (indirect) id. */
+    optional<int64_t> critHi;
+    /** @brief WARNHYST, the hysteresis of the warning alarms. */
+    optional<int64_t> warnHyst;
+    /** @brief CRITHYST, the hysteresis of the critical alarms. */
+    optional<int64_t> critHyst;
+    /** @brief DEBOUNCE, of the threshold alarms. */
+    optional<hwmon::Debounce> debounce;
+    /** @brief PWM_TARGET, the pwm id a fan's target is written to. */
+    std::string pwmTarget;
+    /** @brief ENABLE, the value written to the fan's pwm_enable. */
+    optional<unsigned long> enable;
+    /** @brief INTERVAL, in microseconds. */
+    optional<uint64_t> interval;
+    /** @brief DEADBAND */
+    optional<hwmon::Deadband> deadband;
+    /** @brief HEARTBEAT, in microseconds. */
+    optional<uint64_t> heartbeat;
+    /** @brief HISTORY, readings kept, zero for none. */
+    optional<size_t> history;
+};
+
+/** @brief Settings of a device and its sensors. */
+struct Device
+{
+    /** @brief REMOVERCS, for all the sensors. */
+    std::unordered_set<int> removeRCs;
+    /** @brief INTERVAL, in microseconds. */
+    optional<uint64_t> interval;
+    /** @brief UPDATE_INTERVAL, in milliseconds. */
+    optional<uint64_t> updateInterval;
+    /** @brief TARGET_MODE */
+    targetType targetMode = targetType::DEFAULT;
+    /** @brief DEADBAND, for sensors without their own. */
+    optional<hwmon::Deadband> deadband;
+    /** @brief DEBOUNCE, for sensors without their own. */
+    optional<hwmon::Debounce> debounce;
+    /** @brief HEARTBEAT, for sensors without their own. */
+    optional<uint64_t> heartbeat;
+    /** @brief HISTORY, for sensors without their own. */
+    optional<size_t> history;
+    /** @brief STAT_WINDOWS, history statistics window lengths. */
+    std::vector<size_t> statWindows;
+    /** @brief COALESCE_SIGNALS */
+    bool coalesceSignals = false;
+    /** @brief ALARM_EVENTS */
+    bool alarmEvents = false;
+    /** @brief CHIP_THRESHOLDS */
+    bool chipThresholds = false;
+    /** @brief SENSOR_TABLE */
+    bool sensorTable = false;
+    /** @brief READ_THREADS */
+    size_t readThreads = 0;
+    /** @brief SNAPSHOT_INTERVAL, in microseconds, zero to disable. */
+    uint64_t snapshotInterval = 0;
+    /** @brief SNAPSHOT_MAX_AGE, in microseconds. */
+    optional<uint64_t> snapshotMaxAge;
+
+    /** @brief The sensor settings, by <type><id>. */
+    std::unordered_map<std::string, Sensor> sensors;
+
+    /** @brief The settings that couldn't be parsed, as KEY=VALUE. */
+    std::vector<std::string> errors;
+
+    /** @brief Get a sensor's settings
+     *
+     *  @param[in] type - sensor type, like 'temp'
+     *  @param[in] id - sensor ID, like '5'
+     *
+     *  @return The settings, the defaults if there are none.
+     */
+    const Sensor& sensor(const std::string& type,
+                         const std::string& id) const;
+
+    /** @brief Get a sensor's settings
+     *
+     *  @param[in] sensor - Sensor details
+     *
+     *  @return The settings, the defaults if there are none.
+     */
+    const Sensor& sensor(const SensorSet::key_type& sensor) const
+    {
+        return this->sensor(sensor.first, sensor.second);
+    }
+};
+
+/** @brief Parses device settings
+ *
+ *  Settings that aren't the device's are ignored, and those with
+ *  invalid values are left at their defaults and listed in errors.
+ *
+ *  @param[in] settings - the settings to parse
+ *
+ *  @return Device - the parsed settings
+ */
+Device parse(const env::Settings& settings);
+
+/** @brief Overlays the settings in a JSON config file
+ *
+ *  The file holds an object of device settings, named as in the
+ *  environment, and a "sensors" object of per sensor settings:
+ *
+ *      {
+ *          "INTERVAL": 500000,
+ *          "REMOVERCS": [6, 110],
+ *          "sensors": {
+ *              "temp1": { "LABEL": "ambient", "WARNHI": 40000 }
+ *          }
+ *      }
+ *
+ *  Numbers and booleans are stored as their text and arrays are
+ *  joined with commas, so the result parses as if it were set in
+ *  the environment.
+ *
+ *  Only built with --enable-config-file.
+ *
+ *  @param[in] path - the file to load
+ *  @param[in,out] settings - the settings to overlay
+ *
+ *  @return false if the file can't be read or parsed.
+ */
+bool loadJson(const std::string& path, env::Settings& settings);
+
+/** @brief Parses the environment, logging any invalid settings
+ *
+ *  The JSON file named by the CONFIG_FILE setting, if any, is
+ *  overlaid on the environment first.
+ *
+ *  @return Device - the parsed settings
+ */
+Device load();
+
+} // namespace config
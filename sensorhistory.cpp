@@ -0,0 +1,152 @@
+/**
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <system_error>
+#include <string.h>
+
+#include "sensorhistory.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+constexpr decltype(SensorHistory::interfaceName) SensorHistory::interfaceName;
+
+const sd_bus_vtable SensorHistory::vtable[] =
+{
+    SD_BUS_VTABLE_START(0),
+    SD_BUS_PROPERTY("Capacity", "t", getCapacity, 0,
+                    SD_BUS_VTABLE_PROPERTY_CONST),
+    SD_BUS_PROPERTY("Statistics", "a(ttxxdd)", getStatistics, 0,
+                    SD_BUS_VTABLE_PROPERTY_EMITS_INVALIDATION),
+    SD_BUS_METHOD("GetHistory", "t", "a(tx)", getHistory,
+                  SD_BUS_VTABLE_UNPRIVILEGED),
+    SD_BUS_VTABLE_END
+};
+
+int SensorHistory::getCapacity(sd_bus* bus, const char* path,
+                               const char* interface, const char* property,
+                               sd_bus_message* reply, void* userData,
+                               sd_bus_error* error)
+{
+    auto sensor = static_cast<SensorHistory*>(userData);
+    return sd_bus_message_append(reply, "t",
+                                 static_cast<uint64_t>(
+                                     sensor->history.capacity()));
+}
+
+int SensorHistory::getStatistics(sd_bus* bus, const char* path,
+                                 const char* interface, const char* property,
+                                 sd_bus_message* reply, void* userData,
+                                 sd_bus_error* error)
+{
+    auto sensor = static_cast<SensorHistory*>(userData);
+
+    auto r = sd_bus_message_open_container(reply, 'a', "(ttxxdd)");
+    for (size_t n = 0; r >= 0 && n < sensor->history.windows(); ++n)
+    {
+        auto s = sensor->history.statistics(n);
+        r = sd_bus_message_append(reply, "(ttxxdd)",
+                                  static_cast<uint64_t>(s.window),
+                                  static_cast<uint64_t>(s.count),
+                                  s.min, s.max, s.mean, s.stddev);
+    }
+    if (r < 0)
+    {
+        return r;
+    }
+    return sd_bus_message_close_container(reply);
+}
+
+int SensorHistory::getHistory(sd_bus_message* msg, void* userData,
+                              sd_bus_error* error)
+{
+    auto sensor = static_cast<SensorHistory*>(userData);
+    const auto& history = sensor->history;
+
+    uint64_t count = 0;
+    auto r = sd_bus_message_read(msg, "t", &count);
+    if (r < 0)
+    {
+        return r;
+    }
+
+    sd_bus_message* reply = nullptr;
+    r = sd_bus_message_new_method_return(msg, &reply);
+    if (r < 0)
+    {
+        return r;
+    }
+
+    // The whole slice goes in the one reply.
+    auto first = history.size() - std::min<uint64_t>(count, history.size());
+    r = sd_bus_message_open_container(reply, 'a', "(tx)");
+    for (auto n = first; r >= 0 && n < history.size(); ++n)
+    {
+        r = sd_bus_message_append(reply, "(tx)",
+                                  history[n].time, history[n].value);
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_message_close_container(reply);
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_send(nullptr, reply, nullptr);
+    }
+
+    sd_bus_message_unref(reply);
+    return r;
+}
+
+SensorHistory::SensorHistory(sdbusplus::bus::bus& bus,
+                             const std::string& path,
+                             size_t capacity,
+                             const std::vector<size_t>& windows,
+                             bool announce) :
+    bus(bus.get()),
+    path(path),
+    history(capacity, windows)
+{
+    auto r = sd_bus_add_object_vtable(bus.get(), &slot, path.c_str(),
+                                      interfaceName, vtable, this);
+    if (r < 0)
+    {
+        throw std::system_error(-r, std::generic_category(), strerror(-r));
+    }
+
+    if (announce)
+    {
+        sd_bus_emit_interfaces_added(this->bus, path.c_str(), interfaceName,
+                                     nullptr);
+    }
+}
+
+SensorHistory::~SensorHistory()
+{
+    sd_bus_emit_interfaces_removed(bus, path.c_str(), interfaceName,
+                                   nullptr);
+    sd_bus_slot_unref(slot);
+}
+
+bool SensorHistory::add(int64_t value)
+{
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch());
+    return history.add(now.count(), value);
+}
+
+} // namespace hwmon
+} // namespace phosphor
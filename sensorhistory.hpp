@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sdbusplus/bus.hpp>
+
+#include "history.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+/** @class SensorHistory
+ *  @brief A sensor's recent readings and their statistics.
+ *
+ *  Published on the sensor's object as the
+ *  xyz.openbmc_project.Hwmon.History interface:
+ *
+ *  - Capacity: readings kept.
+ *  - Statistics: an array of (window, count, min, max, mean, stddev),
+ *    one per window, over the latest window readings, or the count
+ *    read so far until there are that many.
+ *  - GetHistory(t count) -> a(tx): the latest count readings, oldest
+ *    first, as CLOCK_MONOTONIC microseconds and adjusted value.
+ *
+ *  The statistics change with every reading, so they're only signalled
+ *  once a window fills up again, and then only invalidated, for clients
+ *  to read on demand.  The owner reports that change with the sensor's
+ *  other signals.
+ *
+ *  The interface is announced with InterfacesAdded when it's added to
+ *  an object that already was, otherwise with the object.
+ */
+class SensorHistory
+{
+    public:
+        SensorHistory() = delete;
+        SensorHistory(const SensorHistory&) = delete;
+        SensorHistory& operator=(const SensorHistory&) = delete;
+        SensorHistory(SensorHistory&&) = delete;
+        SensorHistory& operator=(SensorHistory&&) = delete;
+        ~SensorHistory();
+
+        /** @brief The history's D-Bus interface name. */
+        static constexpr auto interfaceName =
+            "xyz.openbmc_project.Hwmon.History";
+
+        /** @brief Constructs the history and adds it to D-Bus
+         *
+         *  @param[in] bus - D-Bus connection to publish on
+         *  @param[in] path - the sensor's D-Bus object path
+         *  @param[in] capacity - readings kept
+         *  @param[in] windows - statistics window lengths, in readings
+         *  @param[in] announce - whether the object was already
+         *                        announced, without the history
+         */
+        SensorHistory(sdbusplus::bus::bus& bus, const std::string& path,
+                      size_t capacity, const std::vector<size_t>& windows,
+                      bool announce);
+
+        /** @brief Record a reading, timestamped now
+         *
+         *  @param[in] value - the adjusted value
+         *
+         *  @return Whether Statistics should be signalled, a window
+         *          was completed.
+         */
+        bool add(int64_t value);
+
+    private:
+        /** @brief sd-bus getter of the Capacity property. */
+        static int getCapacity(sd_bus* bus, const char* path,
+                               const char* interface, const char* property,
+                               sd_bus_message* reply, void* userData,
+                               sd_bus_error* error);
+
+        /** @brief sd-bus getter of the Statistics property. */
+        static int getStatistics(sd_bus* bus, const char* path,
+                                 const char* interface, const char* property,
+                                 sd_bus_message* reply, void* userData,
+                                 sd_bus_error* error);
+
+        /** @brief sd-bus handler of the GetHistory method. */
+        static int getHistory(sd_bus_message* msg, void* userData,
+                              sd_bus_error* error);
+
+        /** @brief The history's D-Bus interface. */
+        static const sd_bus_vtable vtable[];
+
+        /** @brief Registration of the D-Bus interface. */
+        sd_bus_slot* slot = nullptr;
+
+        /** @brief D-Bus connection, for signals. */
+        sd_bus* bus;
+        /** @brief The sensor's D-Bus object path. */
+        std::string path;
+
+        History history;
+};
+
+} // namespace hwmon
+} // namespace phosphor
@@ -13,40 +13,122 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
-#include <experimental/filesystem>
-#include <regex>
-#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <dirent.h>
+#include <system_error>
 #include "sensorset.hpp"
 #include "hwmon.hpp"
 
-// TODO: Issue#2 - STL regex generates really bloated code.  Use POSIX regex
-//       interfaces instead.
-static const std::regex sensors_regex =
-    std::regex("^(fan|in|temp|power|energy|curr)([0-9]+)_([a-z]*)",
-               std::regex::extended);
-static const auto sensor_regex_match_count = 4;
+namespace
+{
 
-SensorSet::SensorSet(const std::string& path)
+/** @brief The sensor types of the hwmon sysfs ABI. */
+const std::string types[] =
 {
-    namespace fs = std::experimental::filesystem;
+    "curr", "cpu", "energy", "fan", "humidity", "in", "intrusion",
+    "power", "pwm", "temp",
+};
+
+/** @brief A name within a directory entry, not owned. */
+struct Token
+{
+    const char* data;
+    size_t size;
+
+    bool operator==(const std::string& s) const
+    {
+        return s.size() == size && s.compare(0, size, data, size) == 0;
+    }
+
+    std::string str() const
+    {
+        return std::string(data, size);
+    }
+};
+
+/** @brief Splits a file name like temp5_max_alarm into its parts.
+ *
+ *  @return false if the name isn't a sensor attribute.
+ */
+bool split(const char* name, Token& type, Token& id, Token& suffix)
+{
+    auto p = name;
+    while (*p >= 'a' && *p <= 'z')
+    {
+        ++p;
+    }
+    type = {name, static_cast<size_t>(p - name)};
+
+    auto start = p;
+    while (*p >= '0' && *p <= '9')
+    {
+        ++p;
+    }
+    id = {start, static_cast<size_t>(p - start)};
 
-    for (const auto& file : fs::directory_iterator(path))
+    if (type.size == 0 || id.size == 0)
     {
-        std::smatch match;
-        auto fileName = file.path().filename();
-        std::regex_search(fileName.native(), match, sensors_regex);
+        return false;
+    }
+
+    if (*p == '_')
+    {
+        ++p;
+    }
+    else if (*p)
+    {
+        return false;
+    }
 
-        if (match.size() != sensor_regex_match_count)
+    start = p;
+    while ((*p >= 'a' && *p <= 'z') || (*p >= '0' && *p <= '9') || *p == '_')
+    {
+        ++p;
+    }
+    suffix = {start, static_cast<size_t>(p - start)};
+
+    return *p == '\0';
+}
+
+} // namespace
+
+SensorSet::SensorSet(const std::string& path)
+{
+    auto dir = opendir(path.c_str());
+    if (!dir)
+    {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    while (true)
+    {
+        errno = 0;
+        auto d = readdir(dir);
+        if (!d)
         {
-            continue;
+            auto rc = errno;
+            closedir(dir);
+            if (rc)
+            {
+                throw std::system_error(rc, std::generic_category(), path);
+            }
+            break;
         }
 
-        if (match[3] == hwmon::entry::label)
+        Token type, id, suffix;
+        if (!split(d->d_name, type, id, suffix) ||
+            suffix == hwmon::entry::label ||
+            std::none_of(std::begin(types), std::end(types),
+                         [&type](const std::string& t)
+                         {
+                             return type == t;
+                         }))
         {
             continue;
         }
 
-        container[make_pair(match[1], match[2])].emplace(match[3]);
+        container[make_pair(type.str(), id.str())].emplace(suffix.str());
     }
 }
 
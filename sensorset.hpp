@@ -16,6 +16,10 @@
  *
  *              key:   pair<string, string> = {"temp", "5"}
  *              value: std::string = "input"
+ *
+ *          Every sensor type and attribute of the hwmon sysfs ABI is
+ *          found, so temp5_max_alarm adds "max_alarm" and pwm1 adds an
+ *          empty attribute.  Label files are left out.
  */
 class SensorSet
 {
@@ -32,6 +36,7 @@ class SensorSet
          *
          * @param[in] path - path to the hwmon device directory
          *
+         * @throws std::system_error if the directory can't be read.
          */
         explicit SensorSet(const std::string& path);
         ~SensorSet() = default;
@@ -61,6 +66,18 @@ class SensorSet
             return const_cast<const container_t&>(container).end();
         }
 
+        /**
+         * @brief Finds a sensor in the map
+         *
+         * @param[in] key - the sensor to find
+         *
+         * @return const_iterator - end() if not found
+         */
+        container_t::const_iterator find(const key_type& key) const
+        {
+            return container.find(key);
+        }
+
     private:
 
         /**
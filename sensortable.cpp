@@ -0,0 +1,234 @@
+/**
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cerrno>
+#include <cstdio>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sensortable.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+namespace
+{
+
+/** @brief Map a table file for writing. */
+table::Header* map(int fd)
+{
+    auto addr = mmap(nullptr, table::size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    return (addr == MAP_FAILED) ? nullptr : static_cast<table::Header*>(addr);
+}
+
+/** @brief Copy a string into a fixed-size field, NUL terminated. */
+template <size_t N>
+void copy(char (&field)[N], const std::string& value)
+{
+    auto n = value.copy(field, N - 1);
+    memset(field + n, 0, N - n);
+}
+
+} // namespace
+
+SensorTable::SensorTable(const std::string& path)
+{
+    if (!reuse(path))
+    {
+        create(path);
+    }
+
+    begin();
+    clear();
+    header->writer = getpid();
+    end();
+}
+
+SensorTable::~SensorTable()
+{
+    begin();
+    clear();
+    header->writer = 0;
+    end();
+
+    munmap(header, table::size);
+}
+
+bool SensorTable::reuse(const std::string& path)
+{
+    auto fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) || st.st_size != static_cast<off_t>(table::size))
+    {
+        close(fd);
+        return false;
+    }
+
+    header = map(fd);
+    close(fd);
+    if (!header)
+    {
+        return false;
+    }
+
+    if (header->magic != table::magic ||
+        header->version != table::version ||
+        header->recordSize != sizeof(table::Record) ||
+        header->capacity != table::capacity ||
+        header->count > table::capacity)
+    {
+        munmap(header, table::size);
+        header = nullptr;
+        return false;
+    }
+
+    // A writer that died mid-write left the sequence odd.
+    if (header->sequence & 1)
+    {
+        ++header->sequence;
+    }
+
+    return true;
+}
+
+void SensorTable::create(const std::string& path)
+{
+    // Built aside and renamed into place, so readers never map a
+    // partial header.
+    auto tmp = path + ".tmp";
+    auto fd = open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), tmp);
+    }
+
+    if (ftruncate(fd, table::size))
+    {
+        auto e = errno;
+        close(fd);
+        unlink(tmp.c_str());
+        throw std::system_error(e, std::generic_category(), tmp);
+    }
+
+    header = map(fd);
+    auto e = errno;
+    close(fd);
+    if (!header)
+    {
+        unlink(tmp.c_str());
+        throw std::system_error(e, std::generic_category(), tmp);
+    }
+
+    header->magic = table::magic;
+    header->version = table::version;
+    header->recordSize = sizeof(table::Record);
+    header->capacity = table::capacity;
+
+    if (std::rename(tmp.c_str(), path.c_str()))
+    {
+        e = errno;
+        munmap(header, table::size);
+        header = nullptr;
+        unlink(tmp.c_str());
+        throw std::system_error(e, std::generic_category(), path);
+    }
+}
+
+void SensorTable::begin()
+{
+    if (depth++)
+    {
+        return;
+    }
+
+    auto sequence = __atomic_load_n(&header->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void SensorTable::end()
+{
+    if (--depth)
+    {
+        return;
+    }
+
+    auto sequence = __atomic_load_n(&header->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->sequence, sequence + 1, __ATOMIC_RELEASE);
+}
+
+void SensorTable::clear()
+{
+    for (size_t n = 0; n < header->count; ++n)
+    {
+        record(n).status &= ~table::PRESENT;
+    }
+}
+
+size_t SensorTable::add(const std::string& name, const std::string& path)
+{
+    size_t n = 0;
+    while (n < header->count && name.compare(record(n).name))
+    {
+        ++n;
+    }
+    if (n == table::capacity)
+    {
+        return npos;
+    }
+
+    begin();
+    auto& r = record(n);
+    if (n == header->count)
+    {
+        copy(r.name, name);
+        ++header->count;
+    }
+    copy(r.path, path);
+    r.status |= table::PRESENT;
+    end();
+
+    return n;
+}
+
+void SensorTable::update(size_t index, int64_t value, uint32_t status,
+                         uint32_t alarms)
+{
+    begin();
+    auto& r = record(index);
+    r.value = value;
+    r.status = status | table::PRESENT;
+    r.alarms = alarms;
+    end();
+}
+
+void SensorTable::stamp(size_t index, uint64_t time)
+{
+    begin();
+    record(index).time = time;
+    end();
+}
+
+} // namespace hwmon
+} // namespace phosphor
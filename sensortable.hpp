@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace phosphor
+{
+namespace hwmon
+{
+namespace table
+{
+
+/** @brief "HWMT", identifies a sensor table file. */
+static constexpr uint32_t magic = 0x544d5748;
+/** @brief Layout version, changed with any change to the layout. */
+static constexpr uint16_t version = 1;
+/** @brief Records in a table. */
+static constexpr uint32_t capacity = 256;
+
+/** @brief Status flags, as bits of Record::status. */
+enum Status : uint32_t
+{
+    /** @brief The sensor currently has an object. */
+    PRESENT = 1 << 0,
+    /** @brief The OperationalStatus Functional property. */
+    FUNCTIONAL = 1 << 1,
+    /** @brief The value was restored from the restart snapshot and
+     *         hasn't been read since. */
+    STALE = 1 << 2,
+};
+
+/** @brief Alarm properties, as bits of Record::alarms. */
+enum Alarm : uint32_t
+{
+    WARN_LO = 1 << 0,
+    WARN_HI = 1 << 1,
+    CRIT_LO = 1 << 2,
+    CRIT_HI = 1 << 3,
+};
+
+/** @brief The start of a table file. */
+struct Header
+{
+    uint32_t magic;
+    uint16_t version;
+    /** @brief sizeof(Record). */
+    uint16_t recordSize;
+    /** @brief Records in the file. */
+    uint32_t capacity;
+    /** @brief Records ever used, the rest are zero. */
+    uint32_t count;
+    /** @brief Sequence lock of the whole table, odd while it's
+     *         being written. */
+    uint64_t sequence;
+    /** @brief Process id of the writer, zero once it's stopped. */
+    uint64_t writer;
+    uint8_t reserved[32];
+};
+
+/** @brief The state of a sensor, at the index of its stable id.
+ *
+ *  A sensor keeps its record while the file exists, across restarts,
+ *  so readers can look up the index by name once.
+ */
+struct Record
+{
+    /** @brief Sensor type and id, like 'temp1', NUL terminated. */
+    char name[16];
+    /** @brief D-Bus object path, NUL terminated, truncated if long. */
+    char path[80];
+    /** @brief The latest value, adjusted but not held back by a
+     *         DEADBAND or HEARTBEAT. */
+    int64_t value;
+    /** @brief CLOCK_MONOTONIC time of the value's reading, in
+     *         microseconds, zero if it wasn't read. */
+    uint64_t time;
+    /** @brief Status flags. */
+    uint32_t status;
+    /** @brief Alarm properties that are set. */
+    uint32_t alarms;
+    uint8_t reserved[8];
+};
+
+static_assert(sizeof(Header) == 64, "Header layout changed");
+static_assert(sizeof(Record) == 128, "Record layout changed");
+
+/** @brief Size of a table file. */
+static constexpr size_t size = sizeof(Header) + capacity * sizeof(Record);
+
+/** @brief Take a consistent copy of a mapped table's records
+ *
+ *  Retries while the table is being written, up to a limit so a
+ *  writer that died mid-write can't hold the reader up.
+ *
+ *  @param[in] header - the mapped table file
+ *  @param[out] records - the copies, room for header->capacity
+ *  @param[out] count - the records copied, header->count
+ *  @param[in] tries - attempts before giving up
+ *
+ *  @return false if no consistent copy could be taken.
+ */
+inline bool read(const Header* header, Record* records, size_t& count,
+                 size_t tries = 1000)
+{
+    auto first = reinterpret_cast<const Record*>(header + 1);
+    while (tries--)
+    {
+        auto begin = __atomic_load_n(&header->sequence, __ATOMIC_ACQUIRE);
+        if (begin & 1)
+        {
+            continue;
+        }
+
+        count = std::min(__atomic_load_n(&header->count, __ATOMIC_RELAXED),
+                         header->capacity);
+        memcpy(records, first, count * sizeof(Record));
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&header->sequence, __ATOMIC_RELAXED) == begin)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace table
+
+/** @class SensorTable
+ *  @brief Writer of a memory-mapped table of sensor states.
+ *
+ *  A fixed table::Header followed by table::capacity fixed-size
+ *  table::Records, for local readers that can't afford a D-Bus
+ *  round trip per reading.  Writes are bracketed by begin() and
+ *  end(), or by each update() alone, and readers retry their copy
+ *  with table::read() if the header's sequence moved, so they see
+ *  whole brackets without taking any lock.
+ *
+ *  An existing table with the same layout is reused, keeping the
+ *  sensors' ids and its readers' mappings; otherwise a new one
+ *  replaces it.
+ */
+class SensorTable
+{
+    public:
+        SensorTable() = delete;
+        SensorTable(const SensorTable&) = delete;
+        SensorTable& operator=(const SensorTable&) = delete;
+        SensorTable(SensorTable&&) = delete;
+        SensorTable& operator=(SensorTable&&) = delete;
+
+        /** @brief Maps the table, creating or resetting it
+         *
+         *  All the records are left not PRESENT.  Errors are thrown
+         *  as std::system_error.
+         *
+         *  @param[in] path - the table file, on tmpfs
+         */
+        explicit SensorTable(const std::string& path);
+
+        /** @brief Marks the table as no longer written and unmaps it. */
+        ~SensorTable();
+
+        /** @brief Index returned when a sensor has no record. */
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        /** @brief Start a bracket of writes, which may nest. */
+        void begin();
+
+        /** @brief End a bracket of writes, publishing them once the
+         *         outermost one ends. */
+        void end();
+
+        /** @brief Mark every record not PRESENT, for add() to mark the
+         *         sensors that are again, within a bracket. */
+        void clear();
+
+        /** @brief Get a sensor's record, marking it PRESENT
+         *
+         *  @param[in] name - sensor type and id, like 'temp1'
+         *  @param[in] path - the sensor's D-Bus object path
+         *
+         *  @return The record's index, the sensor's previous one if it
+         *          had one, npos if the table is full.
+         */
+        size_t add(const std::string& name, const std::string& path);
+
+        /** @brief Update a PRESENT sensor's record
+         *
+         *  @param[in] index - the index from add()
+         *  @param[in] value - the latest value
+         *  @param[in] status - status flags besides PRESENT
+         *  @param[in] alarms - alarm properties that are set
+         */
+        void update(size_t index, int64_t value, uint32_t status,
+                    uint32_t alarms);
+
+        /** @brief Set when a sensor's value was read
+         *
+         *  @param[in] index - the index from add()
+         *  @param[in] time - CLOCK_MONOTONIC time, in microseconds
+         */
+        void stamp(size_t index, uint64_t time);
+
+    private:
+        /** @brief Map the file, if it's a table with this layout. */
+        bool reuse(const std::string& path);
+
+        /** @brief Replace the file with an empty table and map it. */
+        void create(const std::string& path);
+
+        /** @brief The record at an index. */
+        table::Record& record(size_t index)
+        {
+            return reinterpret_cast<table::Record*>(header + 1)[index];
+        }
+
+        table::Header* header = nullptr;
+        /** @brief Depth of nested brackets. */
+        size_t depth = 0;
+};
+
+} // namespace hwmon
+} // namespace phosphor
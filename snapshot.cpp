@@ -0,0 +1,191 @@
+/**
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+
+#include "snapshot.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+namespace snapshot
+{
+
+/** @brief Identifies the snapshot file format. */
+static constexpr uint32_t magic = 0x534d5748; // "HWMS"
+/** @brief Bumped whenever Entry or its encoding changes. */
+static constexpr uint32_t version = 2;
+/** @brief Identifies the current boot. */
+static constexpr auto bootIdPath = "/proc/sys/kernel/random/boot_id";
+
+namespace
+{
+
+template <typename T>
+void put(std::string& buf, T value)
+{
+    buf.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void put(std::string& buf, const std::string& value)
+{
+    put<uint32_t>(buf, value.size());
+    buf.append(value);
+}
+
+/** @brief Bounds checked reader of a snapshot buffer. */
+struct Reader
+{
+    const std::string& buf;
+    size_t pos = 0;
+    bool ok = true;
+
+    template <typename T>
+    T get()
+    {
+        T value{};
+        if (!ok || buf.size() - pos < sizeof(value))
+        {
+            ok = false;
+            return value;
+        }
+        memcpy(&value, buf.data() + pos, sizeof(value));
+        pos += sizeof(value);
+        return value;
+    }
+
+    std::string str()
+    {
+        auto size = get<uint32_t>();
+        if (!ok || buf.size() - pos < size)
+        {
+            ok = false;
+            return {};
+        }
+        pos += size;
+        return buf.substr(pos - size, size);
+    }
+};
+
+} // namespace
+
+Stamp Stamp::now()
+{
+    Stamp stamp;
+    std::ifstream ifs(bootIdPath);
+    std::getline(ifs, stamp.boot);
+
+    timespec ts{};
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    stamp.time = ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+
+    return stamp;
+}
+
+bool save(const std::string& path, const std::vector<Entry>& entries,
+          const Stamp& stamp)
+{
+    std::string buf;
+    put(buf, magic);
+    put(buf, version);
+    put(buf, stamp.boot);
+    put(buf, stamp.time);
+    put<uint32_t>(buf, entries.size());
+
+    for (const auto& e : entries)
+    {
+        put(buf, e.type);
+        put(buf, e.id);
+        put<uint32_t>(buf, e.attributes.size());
+        for (const auto& a : e.attributes)
+        {
+            put(buf, a);
+        }
+        put(buf, e.path);
+        put(buf, e.value);
+        put<uint8_t>(buf, e.functional);
+    }
+
+    auto tmp = path + ".tmp";
+    {
+        std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+        ofs.write(buf.data(), buf.size());
+        ofs.flush();
+        if (ofs.fail())
+        {
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+std::vector<Entry> load(const std::string& path,
+                        std::chrono::microseconds maxAge,
+                        const Stamp& stamp)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    std::string buf((std::istreambuf_iterator<char>(ifs)),
+                    std::istreambuf_iterator<char>());
+
+    Reader r{buf};
+    if (r.get<uint32_t>() != magic || r.get<uint32_t>() != version)
+    {
+        return {};
+    }
+
+    // The sensors' states are only worth publishing while they're
+    // likely to still hold.
+    auto boot = r.str();
+    auto time = r.get<uint64_t>();
+    if (!r.ok || boot.empty() || boot != stamp.boot || time > stamp.time ||
+        stamp.time - time > static_cast<uint64_t>(maxAge.count()))
+    {
+        return {};
+    }
+
+    auto count = r.get<uint32_t>();
+    std::vector<Entry> entries;
+    for (uint32_t i = 0; r.ok && i < count; ++i)
+    {
+        Entry e;
+        e.type = r.str();
+        e.id = r.str();
+        auto attributes = r.get<uint32_t>();
+        for (uint32_t a = 0; r.ok && a < attributes; ++a)
+        {
+            e.attributes.push_back(r.str());
+        }
+        e.path = r.str();
+        e.value = r.get<int64_t>();
+        e.functional = r.get<uint8_t>();
+        entries.push_back(std::move(e));
+    }
+
+    if (!r.ok || r.pos != buf.size())
+    {
+        return {};
+    }
+
+    return entries;
+}
+
+} // namespace snapshot
+} // namespace hwmon
+} // namespace phosphor
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace hwmon
+{
+namespace snapshot
+{
+
+/** @brief When a snapshot was saved. */
+struct Stamp
+{
+    /** @brief The kernel's boot_id, empty if it couldn't be read. */
+    std::string boot;
+    /** @brief CLOCK_BOOTTIME, in microseconds. */
+    uint64_t time = 0;
+
+    /** @brief The current boot and time. */
+    static Stamp now();
+};
+
+/** @brief The last published state of a sensor. */
+struct Entry
+{
+    /** @brief Sensor type, like 'temp'. */
+    std::string type;
+    /** @brief Sensor id, like '5'. */
+    std::string id;
+    /** @brief The sensor's attributes found in sysfs. */
+    std::vector<std::string> attributes;
+    /** @brief D-Bus object path. */
+    std::string path;
+    /** @brief Sensor value. */
+    int64_t value = 0;
+    /** @brief OperationalStatus Functional property. */
+    bool functional = true;
+};
+
+/** @brief Writes a snapshot of sensor states
+ *
+ *  The snapshot is written to a temporary file which replaces the
+ *  existing one, so readers never see a partial snapshot.  It is
+ *  meant for tmpfs and only readable by the same build on the same
+ *  machine.
+ *
+ *  The alarm properties aren't saved, they're left to the first
+ *  readings after a restart.
+ *
+ *  @param[in] path - the snapshot file
+ *  @param[in] entries - the sensor states
+ *  @param[in] stamp - when the states were published
+ *
+ *  @return false if the snapshot couldn't be written.
+ */
+bool save(const std::string& path, const std::vector<Entry>& entries,
+          const Stamp& stamp = Stamp::now());
+
+/** @brief Reads a snapshot of sensor states
+ *
+ *  Snapshots from another boot, or older than maxAge, are ignored.
+ *
+ *  @param[in] path - the snapshot file
+ *  @param[in] maxAge - the oldest snapshot to accept
+ *  @param[in] stamp - the current boot and time
+ *
+ *  @return The sensor states, empty if the file is missing, invalid
+ *          or out of date.
+ */
+std::vector<Entry> load(const std::string& path,
+                        std::chrono::microseconds maxAge,
+                        const Stamp& stamp = Stamp::now());
+
+} // namespace snapshot
+} // namespace hwmon
+} // namespace phosphor
@@ -1,24 +1,15 @@
 #pragma once
 
 #include <experimental/filesystem>
+#include <functional>
 #include <memory>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/log.hpp>
 #include <xyz/openbmc_project/Sensor/Device/error.hpp>
-#include "env.hpp"
 #include "fan_speed.hpp"
 #include "fan_pwm.hpp"
 #include "hwmonio.hpp"
-
-enum class targetType
-{
-    DEFAULT,
-    RPM,
-    PWM
-};
-
-static constexpr auto RPM_TARGET = "RPM";
-static constexpr auto PWM_TARGET = "PWM";
+#include "sensorconfig.hpp"
 
 /** @class Targets
  *  @brief Target type traits.
@@ -56,7 +47,9 @@ struct Targets<hwmon::FanPwm>
  *  @param[in] sensor - A sensor type and name
  *  @param[in] ioAccess - hwmon sysfs access object
  *  @param[in] devPath - The /sys/devices sysfs path
+ *  @param[in] config - The device's settings
  *  @param[in] info - The sdbusplus server connection and interfaces
+ *  @param[in] failed - Called when writing the target fails
  *
  *  @return A shared pointer to the target interface object
  *          Will be empty if no interface was created
@@ -65,7 +58,9 @@ template <typename T>
 std::shared_ptr<T> addTarget(const SensorSet::key_type& sensor,
                              const hwmonio::HwmonIO& ioAccess,
                              const std::string& devPath,
-                             ObjectInfo& info)
+                             const config::Device& config,
+                             ObjectInfo& info,
+                             std::function<void()> failed)
 {
     std::shared_ptr<T> target;
     namespace fs = std::experimental::filesystem;
@@ -90,7 +85,7 @@ std::shared_ptr<T> addTarget(const SensorSet::key_type& sensor,
     {
         targetName = pwm;
         // If PWM_TARGET is set, use the specified pwm id
-        auto id = env::getEnv("PWM_TARGET", sensor);
+        const auto& id = config.sensor(sensor).pwmTarget;
         if (!id.empty())
         {
             targetId = id;
@@ -105,35 +100,13 @@ std::shared_ptr<T> addTarget(const SensorSet::key_type& sensor,
     if (fs::exists(sysfsFullPath))
     {
         auto useTarget = true;
-        auto tmEnv = env::getEnv("TARGET_MODE");
-        if (!tmEnv.empty())
+        if (config.targetMode == targetType::RPM)
         {
-            std::string mode{tmEnv};
-            std::transform(mode.begin(), mode.end(), mode.begin(), toupper);
-
-            if (mode == RPM_TARGET)
-            {
-                if (type != InterfaceType::FAN_SPEED)
-                {
-                    useTarget = false;
-                }
-            }
-            else if (mode == PWM_TARGET)
-            {
-                if (type != InterfaceType::FAN_PWM)
-                {
-                    useTarget = false;
-                }
-            }
-            else
-            {
-                using namespace phosphor::logging;
-                log<level::ERR>("Invalid TARGET_MODE env var found",
-                        phosphor::logging::entry(
-                                "TARGET_MODE=%s", tmEnv.c_str()),
-                        phosphor::logging::entry(
-                                "DEVPATH=%s", devPath.c_str()));
-            }
+            useTarget = (type == InterfaceType::FAN_SPEED);
+        }
+        else if (config.targetMode == targetType::PWM)
+        {
+            useTarget = (type == InterfaceType::FAN_PWM);
         }
 
         if (useTarget)
@@ -175,7 +148,8 @@ std::shared_ptr<T> addTarget(const SensorSet::key_type& sensor,
                     bus,
                     objPath.c_str(),
                     deferSignals,
-                    targetSpeed);
+                    targetSpeed,
+                    std::move(failed));
             obj[type] = target;
         }
     }
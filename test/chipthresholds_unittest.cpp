@@ -0,0 +1,88 @@
+#include "chip_thresholds.hpp"
+#include "hwmonio_mock.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::StrEq;
+
+class ChipLimitsTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char tmpl[] = "/tmp/chipthresholds_unittest.XXXXXX";
+            ASSERT_NE(nullptr, mkdtemp(tmpl));
+            dir = tmpl;
+
+            std::ofstream{dir + "/temp1_max"};
+            std::ofstream{dir + "/temp1_crit"};
+            chmod((dir + "/temp1_max").c_str(), 0644);
+            chmod((dir + "/temp1_crit").c_str(), 0444);
+        }
+
+        void TearDown() override
+        {
+            unlink((dir + "/temp1_max").c_str());
+            unlink((dir + "/temp1_crit").c_str());
+            rmdir(dir.c_str());
+        }
+
+        hwmon::ChipLimits limits(const char* lo, const char* hi)
+        {
+            auto io = std::make_unique<hwmonio::HwmonIOMock>();
+            mock = io.get();
+            EXPECT_CALL(*mock, path()).WillRepeatedly(Return(dir));
+
+            sensor::valueAdjust adjust;
+            adjust.gain = 0.5;
+            adjust.offset = 1000;
+            return hwmon::ChipLimits(std::move(io), "/sys/devices/chip",
+                                     {"temp", "1"}, adjust, lo, hi);
+        }
+
+        std::string dir;
+        hwmonio::HwmonIOMock* mock = nullptr;
+};
+
+TEST_F(ChipLimitsTest, WritesUnadjustedLimit)
+{
+    auto l = limits(nullptr, "max");
+
+    EXPECT_CALL(*mock, write(80000,
+                             StrEq("temp"),
+                             StrEq("1"),
+                             StrEq("max"),
+                             hwmonio::retries,
+                             hwmonio::delay));
+    EXPECT_TRUE(l.write(true, 41000));
+
+    // The chip has no low limit to write.
+    EXPECT_TRUE(l.write(false, -5000));
+}
+
+TEST_F(ChipLimitsTest, ReadOnlyLimit)
+{
+    auto l = limits(nullptr, "crit");
+
+    EXPECT_CALL(*mock, write(_, _, _, _, _, _)).Times(0);
+    EXPECT_FALSE(l.write(true, 50000));
+}
+
+TEST_F(ChipLimitsTest, WriteFailure)
+{
+    auto l = limits(nullptr, "max");
+
+    EXPECT_CALL(*mock, write(_, _, _, StrEq("max"), _, _))
+        .WillOnce(::testing::Throw(
+                std::system_error(EINVAL, std::generic_category())));
+    EXPECT_FALSE(l.write(true, 41000));
+}
@@ -0,0 +1,34 @@
+#include "deadband.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(DeadbandTest, Absolute)
+{
+    auto deadband = hwmon::Deadband::parse("500");
+    EXPECT_FALSE(deadband.relative);
+    EXPECT_FALSE(deadband.exceeded(30000, 30500));
+    EXPECT_FALSE(deadband.exceeded(30000, 29500));
+    EXPECT_TRUE(deadband.exceeded(30000, 30501));
+    EXPECT_TRUE(deadband.exceeded(30000, 29499));
+}
+
+TEST(DeadbandTest, Relative)
+{
+    auto deadband = hwmon::Deadband::parse("2.5%");
+    EXPECT_TRUE(deadband.relative);
+    EXPECT_FALSE(deadband.exceeded(4000, 4100));
+    EXPECT_TRUE(deadband.exceeded(4000, 4101));
+    EXPECT_FALSE(deadband.exceeded(-4000, -3900));
+    EXPECT_TRUE(deadband.exceeded(-4000, -3899));
+}
+
+TEST(DeadbandTest, Invalid)
+{
+    for (auto setting : {"", "x", "-5"})
+    {
+        auto deadband = hwmon::Deadband::parse(setting);
+        EXPECT_EQ(0, deadband.band);
+        EXPECT_TRUE(deadband.exceeded(1000, 1001));
+        EXPECT_FALSE(deadband.exceeded(1000, 1000));
+    }
+}
@@ -0,0 +1,101 @@
+#include "debounce.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(DebounceTest, Parse)
+{
+    hwmon::Debounce debounce;
+    EXPECT_TRUE(hwmon::Debounce::parse("3/5", debounce));
+    EXPECT_EQ(3, debounce.count);
+    EXPECT_EQ(5, debounce.window);
+
+    EXPECT_TRUE(hwmon::Debounce::parse("2", debounce));
+    EXPECT_EQ(2, debounce.count);
+    EXPECT_EQ(2, debounce.window);
+
+    for (auto setting : {"", "x", "0", "3/2", "1/33", "2/", "2/4x"})
+    {
+        EXPECT_FALSE(hwmon::Debounce::parse(setting, debounce));
+        EXPECT_EQ(2, debounce.count);
+    }
+}
+
+TEST(AlarmFilterTest, Unfiltered)
+{
+    hwmon::AlarmFilter filter;
+    EXPECT_EQ(std::make_pair(false, true), filter.sample(100, 0, 100));
+    EXPECT_EQ(std::make_pair(false, false), filter.sample(99, 0, 100));
+    EXPECT_EQ(std::make_pair(true, false), filter.sample(0, 0, 100));
+}
+
+TEST(AlarmFilterTest, Hysteresis)
+{
+    hwmon::AlarmFilter filter;
+    filter.hysteresis = 5;
+
+    EXPECT_TRUE(filter.sample(100, 0, 100).second);
+    EXPECT_TRUE(filter.sample(96, 0, 100).second);
+    EXPECT_TRUE(filter.sample(95, 0, 100).second);
+    EXPECT_FALSE(filter.sample(94, 0, 100).second);
+    EXPECT_FALSE(filter.sample(99, 0, 100).second);
+
+    EXPECT_TRUE(filter.sample(-1, 0, 100).first);
+    EXPECT_TRUE(filter.sample(5, 0, 100).first);
+    EXPECT_FALSE(filter.sample(6, 0, 100).first);
+}
+
+TEST(AlarmFilterTest, Debounce)
+{
+    hwmon::AlarmFilter filter;
+    hwmon::Debounce::parse("2/3", filter.debounce);
+
+    // A single sample past the threshold doesn't raise the alarm.
+    EXPECT_FALSE(filter.sample(100, 0, 100).second);
+    EXPECT_FALSE(filter.sample(50, 0, 100).second);
+    EXPECT_TRUE(filter.sample(100, 0, 100).second);
+
+    // Nor does a single sample back clear it.
+    EXPECT_TRUE(filter.sample(100, 0, 100).second);
+    EXPECT_TRUE(filter.sample(50, 0, 100).second);
+    EXPECT_FALSE(filter.sample(50, 0, 100).second);
+}
+
+TEST(AlarmFilterTest, Reset)
+{
+    hwmon::AlarmFilter filter;
+    hwmon::Debounce::parse("3/3", filter.debounce);
+    filter.reset(false, true);
+
+    EXPECT_TRUE(filter.sample(50, 0, 100).second);
+    EXPECT_TRUE(filter.sample(50, 0, 100).second);
+    EXPECT_FALSE(filter.sample(50, 0, 100).second);
+}
+
+TEST(AlarmFilterTest, Rebase)
+{
+    hwmon::AlarmFilter filter;
+    filter.hysteresis = 5;
+    hwmon::Debounce::parse("2/3", filter.debounce);
+
+    // A raised high threshold still allows the hysteresis.
+    filter.reset(false, true);
+    filter.rebase(96, 100, true);
+    EXPECT_TRUE(filter.alarmHi);
+    filter.rebase(94, 100, true);
+    EXPECT_FALSE(filter.alarmHi);
+    EXPECT_EQ(0u, filter.samplesHi);
+
+    // A lowered one raises its alarm at once, without the hysteresis.
+    filter.rebase(96, 96, true);
+    EXPECT_TRUE(filter.alarmHi);
+    EXPECT_TRUE(filter.sample(50, 0, 96).second);
+
+    // The low alarm and its samples are left alone.
+    filter.reset(true, false);
+    filter.sample(50, 0, 100);
+    auto samples = filter.samplesLo;
+    filter.rebase(120, 110, true);
+    EXPECT_TRUE(filter.alarmLo);
+    EXPECT_EQ(samples, filter.samplesLo);
+    EXPECT_TRUE(filter.alarmHi);
+}
@@ -0,0 +1,68 @@
+#include "env.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+TEST(EnvTest, LoadSettings)
+{
+    char tmpl[] = "/tmp/env_unittest.XXXXXX";
+    auto fd = mkstemp(tmpl);
+    ASSERT_NE(-1, fd);
+    close(fd);
+
+    {
+        std::ofstream ofs(tmpl);
+        ofs << "# A comment\n"
+            << "\n"
+            << "LABEL_temp1=ambient\n"
+            << "  WARNHI_temp1 = 40000\n"
+            << "LABEL_temp2=\"inlet air\"\n"
+            << "not a setting\n";
+    }
+
+    auto settings = env::loadSettings(tmpl);
+    std::remove(tmpl);
+
+    EXPECT_EQ(3, settings.size());
+    EXPECT_EQ("ambient", settings["LABEL_temp1"]);
+    EXPECT_EQ("40000", settings["WARNHI_temp1"]);
+    EXPECT_EQ("inlet air", settings["LABEL_temp2"]);
+}
+
+TEST(EnvTest, MissingSettings)
+{
+    EXPECT_TRUE(env::loadSettings("/nonexistent/env.conf").empty());
+}
+
+TEST(EnvTest, Scope)
+{
+    setenv("ENV_UNITTEST_A", "process", 1);
+    setenv("ENV_UNITTEST_B", "process", 1);
+
+    env::Settings outer{{"ENV_UNITTEST_A", "outer"}};
+    env::Settings inner{{"ENV_UNITTEST_B", "inner"}};
+
+    {
+        env::Scope scope(&outer);
+        EXPECT_EQ("outer", env::getEnv("ENV_UNITTEST_A"));
+        EXPECT_EQ("process", env::getEnv("ENV_UNITTEST_B"));
+
+        {
+            env::Scope scope(&inner);
+            EXPECT_EQ("process", env::getEnv("ENV_UNITTEST_A"));
+            EXPECT_EQ("inner", env::getEnv("ENV_UNITTEST_B"));
+
+            env::Scope none(nullptr);
+            EXPECT_EQ("inner", env::getEnv("ENV_UNITTEST_B"));
+        }
+
+        EXPECT_EQ("outer", env::getEnv("ENV_UNITTEST_A"));
+    }
+
+    EXPECT_EQ("process", env::getEnv("ENV_UNITTEST_A"));
+}
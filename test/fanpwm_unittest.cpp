@@ -93,7 +93,8 @@ TEST(FanPwmTest, BasicConstructorDeferredTest) {
                     bus_mock,
                     objPath.c_str(),
                     defer,
-                    target);
+                    target,
+                    []() {});
 }
 
 TEST(FanPwmTest, BasicConstructorNotDeferredTest) {
@@ -130,7 +131,8 @@ TEST(FanPwmTest, BasicConstructorNotDeferredTest) {
                     bus_mock,
                     objPath.c_str(),
                     defer,
-                    target);
+                    target,
+                    []() {});
 }
 
 TEST(FanPwmTest, WriteTargetValue) {
@@ -160,7 +162,8 @@ TEST(FanPwmTest, WriteTargetValue) {
                     bus_mock,
                     objPath.c_str(),
                     defer,
-                    target);
+                    target,
+                    []() {});
 
     target = 0x64;
 
@@ -215,7 +218,8 @@ TEST(FanPwmTest, WriteTargetValueNoUpdate) {
                     bus_mock,
                     objPath.c_str(),
                     defer,
-                    target);
+                    target,
+                    []() {});
 
     EXPECT_EQ(target, f.target(target));
 }
@@ -0,0 +1,118 @@
+#include "history.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using phosphor::hwmon::History;
+
+TEST(HistoryTest, Ring)
+{
+    History history(3, {});
+    EXPECT_EQ(0u, history.size());
+    EXPECT_EQ(3u, history.capacity());
+    EXPECT_EQ(0u, history.statistics(0).count);
+
+    for (int64_t v = 1; v <= 5; ++v)
+    {
+        history.add(v * 10, v);
+    }
+
+    ASSERT_EQ(3u, history.size());
+    EXPECT_EQ(30u, history[0].time);
+    EXPECT_EQ(3, history[0].value);
+    EXPECT_EQ(5, history[2].value);
+}
+
+TEST(HistoryTest, Windows)
+{
+    History history(4, {2, 8});
+    ASSERT_EQ(2u, history.windows());
+
+    history.add(0, 10);
+    auto s = history.statistics(0);
+    EXPECT_EQ(2u, s.window);
+    EXPECT_EQ(1u, s.count);
+    EXPECT_EQ(10, s.min);
+    EXPECT_EQ(10, s.max);
+    EXPECT_DOUBLE_EQ(10, s.mean);
+    EXPECT_DOUBLE_EQ(0, s.stddev);
+
+    history.add(1, 20);
+    history.add(2, 40);
+
+    s = history.statistics(0);
+    EXPECT_EQ(2u, s.count);
+    EXPECT_EQ(20, s.min);
+    EXPECT_EQ(40, s.max);
+    EXPECT_DOUBLE_EQ(30, s.mean);
+    EXPECT_DOUBLE_EQ(10, s.stddev);
+
+    // Clamped to the capacity.
+    s = history.statistics(1);
+    EXPECT_EQ(4u, s.window);
+    EXPECT_EQ(3u, s.count);
+    EXPECT_EQ(10, s.min);
+    EXPECT_EQ(40, s.max);
+}
+
+TEST(HistoryTest, MatchesRecomputed)
+{
+    History history(16, {1, 5, 16});
+    std::deque<int64_t> kept;
+
+    std::srand(1);
+    for (int n = 0; n < 1000; ++n)
+    {
+        int64_t value = 1000000000000 + std::rand() % 2000 - 1000;
+        history.add(n, value);
+        kept.push_back(value);
+        if (kept.size() > 16)
+        {
+            kept.pop_front();
+        }
+
+        for (size_t w = 0; w < history.windows(); ++w)
+        {
+            auto s = history.statistics(w);
+            auto begin = kept.end() - s.count;
+
+            EXPECT_EQ(*std::min_element(begin, kept.end()), s.min);
+            EXPECT_EQ(*std::max_element(begin, kept.end()), s.max);
+
+            double mean = 0;
+            for (auto v = begin; v != kept.end(); ++v)
+            {
+                mean += *v - value;
+            }
+            mean /= s.count;
+            double variance = 0;
+            for (auto v = begin; v != kept.end(); ++v)
+            {
+                variance += (*v - value - mean) * (*v - value - mean);
+            }
+
+            EXPECT_NEAR(value + mean, s.mean, 1e-3);
+            EXPECT_NEAR(std::sqrt(variance / s.count), s.stddev, 1e-3);
+        }
+    }
+}
+
+TEST(HistoryTest, WindowCompleted)
+{
+    // Windows are clamped to the capacity, so these are 2 and 3.
+    History history(3, {2, 8});
+
+    std::vector<bool> completed;
+    for (int64_t v = 1; v <= 6; ++v)
+    {
+        completed.push_back(history.add(v, v));
+    }
+    EXPECT_EQ(std::vector<bool>({false, true, true, true, false, true}),
+              completed);
+}
@@ -17,7 +17,7 @@ class HwmonIOMock : public HwmonIOInterface
                                          size_t,
                                          std::chrono::milliseconds));
 
-        MOCK_CONST_METHOD6(write, void(uint32_t,
+        MOCK_CONST_METHOD6(write, void(int64_t,
                                        const std::string&,
                                        const std::string&,
                                        const std::string&,
@@ -25,6 +25,14 @@ class HwmonIOMock : public HwmonIOInterface
                                        std::chrono::milliseconds));
 
         MOCK_CONST_METHOD0(path, std::string());
+
+        MOCK_CONST_METHOD3(attribute, Attribute(const std::string&,
+                                                const std::string&,
+                                                const std::string&));
+
+        MOCK_CONST_METHOD3(readBatch, void(const std::vector<Attribute>&,
+                                           std::vector<int64_t>&,
+                                           std::vector<int>&));
 };
 
 } // namespace hwmonio
@@ -0,0 +1,152 @@
+#include "hwmonio.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <experimental/filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+class HwmonIOTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char tmpl[] = "/tmp/hwmonio_unittest.XXXXXX";
+            ASSERT_NE(nullptr, mkdtemp(tmpl));
+            dir = tmpl;
+        }
+
+        void TearDown() override
+        {
+            std::experimental::filesystem::remove_all(dir);
+        }
+
+        void writeFile(const std::string& name, const std::string& content)
+        {
+            std::ofstream ofs(dir + "/" + name);
+            ofs << content;
+        }
+
+        std::string dir;
+};
+
+TEST_F(HwmonIOTest, ReadValue)
+{
+    writeFile("temp1_input", "42000\n");
+    hwmonio::HwmonIO io(dir);
+
+    EXPECT_EQ(42000, io.read("temp", "1", "input", 0, hwmonio::delay));
+}
+
+TEST_F(HwmonIOTest, RereadsCachedAttribute)
+{
+    writeFile("temp1_input", "42000\n");
+    hwmonio::HwmonIO io(dir);
+    EXPECT_EQ(42000, io.read("temp", "1", "input", 0, hwmonio::delay));
+
+    // Rewrite in place so the cached descriptor sees the new value.
+    std::fstream fs(dir + "/temp1_input");
+    fs << "-1500\n";
+    fs.close();
+
+    EXPECT_EQ(-1500, io.read("temp", "1", "input", 0, hwmonio::delay));
+}
+
+TEST_F(HwmonIOTest, WriteValue)
+{
+    writeFile("pwm1", "");
+    hwmonio::HwmonIO io(dir);
+    io.write(128, "pwm", "1", "", 0, hwmonio::delay);
+
+    EXPECT_EQ(128, io.read("pwm", "1", "", 0, hwmonio::delay));
+}
+
+TEST_F(HwmonIOTest, InvalidContentThrows)
+{
+    writeFile("fan1_input", "bogus\n");
+    hwmonio::HwmonIO io(dir);
+
+    EXPECT_THROW(io.read("fan", "1", "input", 0, hwmonio::delay),
+                 std::system_error);
+}
+
+TEST_F(HwmonIOTest, AttributeHandlesAreStable)
+{
+    hwmonio::HwmonIO io(dir);
+    auto temp = io.attribute("temp", "1", "input");
+    auto fan = io.attribute("fan", "1", "input");
+
+    EXPECT_NE(temp, fan);
+    EXPECT_EQ(temp, io.attribute("temp", "1", "input"));
+}
+
+TEST_F(HwmonIOTest, ReadBatch)
+{
+    writeFile("temp1_input", "42000\n");
+    writeFile("temp1_fault", "0\n");
+    writeFile("fan1_input", "bogus\n");
+    hwmonio::HwmonIO io(dir);
+
+    std::vector<hwmonio::HwmonIO::Attribute> attrs{
+        io.attribute("temp", "1", "input"),
+        io.attribute("temp", "1", "fault"),
+        io.attribute("fan", "1", "input"),
+    };
+    std::vector<int64_t> values;
+    std::vector<int> errors;
+
+    io.readBatch(attrs, values, errors);
+
+    ASSERT_EQ(3u, values.size());
+    ASSERT_EQ(3u, errors.size());
+    EXPECT_EQ(0, errors[0]);
+    EXPECT_EQ(42000, values[0]);
+    EXPECT_EQ(0, errors[1]);
+    EXPECT_EQ(0, values[1]);
+    EXPECT_EQ(EINVAL, errors[2]);
+}
+
+TEST_F(HwmonIOTest, ReadBatchGone)
+{
+    writeFile("temp1_input", "42000\n");
+    writeFile("temp2_input", "43000\n");
+    hwmonio::HwmonIO io(dir);
+
+    std::vector<hwmonio::HwmonIO::Attribute> attrs{
+        io.attribute("temp", "1", "input"),
+        io.attribute("temp", "2", "input"),
+    };
+    std::vector<int64_t> values;
+    std::vector<int> errors;
+
+    // The caller is left to notice the device went away.
+    unlink((dir + "/temp2_input").c_str());
+    io.readBatch(attrs, values, errors);
+
+    ASSERT_EQ(2u, errors.size());
+    EXPECT_EQ(0, errors[0]);
+    EXPECT_EQ(42000, values[0]);
+    EXPECT_TRUE(hwmonio::isGone(errors[1]));
+    EXPECT_FALSE(hwmonio::isGone(EAGAIN));
+}
+
+TEST_F(HwmonIOTest, ReadGone)
+{
+    hwmonio::HwmonIO io(dir);
+
+    // Not retried, and left to the caller to handle.
+    try
+    {
+        io.read("temp", "1", "input", hwmonio::retries, hwmonio::delay);
+        FAIL();
+    }
+    catch (const std::system_error& e)
+    {
+        EXPECT_TRUE(hwmonio::isGone(e.code().value()));
+    }
+}
@@ -0,0 +1,127 @@
+#include "hwmonio_uring.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <experimental/filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+class HwmonIOUringTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char tmpl[] = "/tmp/hwmonio_uring_unittest.XXXXXX";
+            ASSERT_NE(nullptr, mkdtemp(tmpl));
+            dir = tmpl;
+
+            for (int i = 1; i <= count; ++i)
+            {
+                std::ofstream ofs(dir + "/temp" + std::to_string(i) +
+                                  "_input");
+                ofs << i * 1000 << "\n";
+            }
+            std::ofstream ofs(dir + "/fan1_input");
+            ofs << "bogus\n";
+        }
+
+        void TearDown() override
+        {
+            std::experimental::filesystem::remove_all(dir);
+        }
+
+        /** @brief Every temp input, and the bogus fan input. */
+        std::vector<hwmonio::HwmonIO::Attribute> batch(
+                const hwmonio::HwmonIO& io)
+        {
+            std::vector<hwmonio::HwmonIO::Attribute> attrs;
+            for (int i = 1; i <= count; ++i)
+            {
+                attrs.push_back(
+                        io.attribute("temp", std::to_string(i), "input"));
+                if (i == 3)
+                {
+                    attrs.push_back(io.attribute("fan", "1", "input"));
+                }
+            }
+            return attrs;
+        }
+
+        /** @brief Check the results of reading batch(). */
+        void check(const std::vector<int64_t>& values,
+                   const std::vector<int>& errors)
+        {
+            ASSERT_EQ(count + 1u, values.size());
+            ASSERT_EQ(count + 1u, errors.size());
+            for (int i = 1, pos = 0; i <= count; ++i, ++pos)
+            {
+                EXPECT_EQ(0, errors[pos]);
+                EXPECT_EQ(i * 1000, values[pos]);
+                if (i == 3)
+                {
+                    EXPECT_EQ(EINVAL, errors[++pos]);
+                }
+            }
+        }
+
+        static constexpr int count = 7;
+        std::string dir;
+};
+
+constexpr int HwmonIOUringTest::count;
+
+TEST_F(HwmonIOUringTest, Fallback)
+{
+    // A ring with no entries can't be set up.
+    hwmonio::HwmonIOUring io(dir, 0);
+
+    std::vector<int64_t> values;
+    std::vector<int> errors;
+    io.readBatch(batch(io), values, errors);
+    check(values, errors);
+}
+
+TEST_F(HwmonIOUringTest, OrderAcrossSubmissions)
+{
+    // Submitted three reads at a time, completed in any order.
+    hwmonio::HwmonIOUring io(dir, 3);
+
+    auto attrs = batch(io);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        std::vector<int64_t> values;
+        std::vector<int> errors;
+        io.readBatch(attrs, values, errors);
+        check(values, errors);
+    }
+}
+
+TEST_F(HwmonIOUringTest, ConcurrentCallers)
+{
+    hwmonio::HwmonIOUring io(dir, 4);
+    auto attrs = batch(io);
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t)
+    {
+        readers.emplace_back([&]()
+        {
+            for (int pass = 0; pass < 50; ++pass)
+            {
+                std::vector<int64_t> values;
+                std::vector<int> errors;
+                io.readBatch(attrs, values, errors);
+                check(values, errors);
+            }
+        });
+    }
+
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+}
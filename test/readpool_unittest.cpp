@@ -0,0 +1,132 @@
+#include "readpool.hpp"
+#include "hwmonio_mock.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <systemd/sd-event.h>
+#include <vector>
+
+using ::testing::_;
+using ::testing::Invoke;
+
+using Attribute = hwmonio::HwmonIOInterface::Attribute;
+
+static void fakeRead(const std::vector<Attribute>& attributes,
+                     std::vector<int64_t>& values,
+                     std::vector<int>& errors)
+{
+    values.resize(attributes.size());
+    errors.resize(attributes.size());
+    for (size_t i = 0; i < attributes.size(); ++i)
+    {
+        values[i] = attributes[i] * 10;
+        errors[i] = (attributes[i] % 3) ? 0 : EAGAIN;
+    }
+}
+
+TEST(ReadPoolTest, ReadAllSplitsBatch)
+{
+    hwmonio::HwmonIOMock io;
+    EXPECT_CALL(io, readBatch(_, _, _))
+        .Times(3)
+        .WillRepeatedly(Invoke(fakeRead));
+
+    std::vector<Attribute> attributes{1, 2, 3, 4, 5, 6, 7};
+    std::vector<int64_t> values;
+    std::vector<int> errors;
+    phosphor::hwmon::ReadPool::readAll(io, 3, attributes, values, errors);
+
+    ASSERT_EQ(attributes.size(), values.size());
+    ASSERT_EQ(attributes.size(), errors.size());
+    for (size_t i = 0; i < attributes.size(); ++i)
+    {
+        EXPECT_EQ(static_cast<int64_t>(attributes[i] * 10), values[i]);
+        EXPECT_EQ((attributes[i] % 3) ? 0 : EAGAIN, errors[i]);
+    }
+}
+
+TEST(ReadPoolTest, ReadAllFewAttributes)
+{
+    hwmonio::HwmonIOMock io;
+    EXPECT_CALL(io, readBatch(_, _, _))
+        .Times(1)
+        .WillRepeatedly(Invoke(fakeRead));
+
+    std::vector<Attribute> attributes{4};
+    std::vector<int64_t> values;
+    std::vector<int> errors;
+    phosphor::hwmon::ReadPool::readAll(io, 8, attributes, values, errors);
+
+    ASSERT_EQ(1u, values.size());
+    EXPECT_EQ(40, values[0]);
+    EXPECT_EQ(0, errors[0]);
+}
+
+TEST(ReadPoolTest, SubmitCompletesOnEventLoop)
+{
+    hwmonio::HwmonIOMock io;
+    EXPECT_CALL(io, readBatch(_, _, _))
+        .WillRepeatedly(Invoke(fakeRead));
+
+    sd_event* event = nullptr;
+    ASSERT_EQ(0, sd_event_new(&event));
+
+    size_t completions = 0;
+    phosphor::hwmon::ReadPool pool(event, io, 3, [&]()
+    {
+        ++completions;
+    });
+
+    std::vector<Attribute> attributes{1, 2, 3, 4, 5, 6, 7};
+    for (auto pass = 0; pass < 2; ++pass)
+    {
+        std::vector<int64_t> values;
+        std::vector<int> errors;
+        ASSERT_TRUE(pool.submit(attributes, values, errors));
+        EXPECT_TRUE(pool.busy());
+        EXPECT_FALSE(pool.submit(attributes, values, errors));
+
+        // Each worker's chunk may complete on its own iteration.
+        while (pool.busy())
+        {
+            ASSERT_LE(0, sd_event_run(event, UINT64_MAX));
+        }
+        EXPECT_EQ(pass + 1u, completions);
+
+        ASSERT_EQ(attributes.size(), values.size());
+        ASSERT_EQ(attributes.size(), errors.size());
+        for (size_t i = 0; i < attributes.size(); ++i)
+        {
+            EXPECT_EQ(static_cast<int64_t>(attributes[i] * 10), values[i]);
+            EXPECT_EQ((attributes[i] % 3) ? 0 : EAGAIN, errors[i]);
+        }
+    }
+
+    sd_event_unref(event);
+}
+
+TEST(ReadPoolTest, DestroyedMidBatch)
+{
+    hwmonio::HwmonIOMock io;
+    EXPECT_CALL(io, readBatch(_, _, _))
+        .WillRepeatedly(Invoke(fakeRead));
+
+    sd_event* event = nullptr;
+    ASSERT_EQ(0, sd_event_new(&event));
+
+    // Destroying the pool waits for the workers, so the buffers only
+    // need to outlive it.
+    std::vector<Attribute> attributes{1, 2, 3, 4, 5};
+    std::vector<int64_t> values;
+    std::vector<int> errors;
+    {
+        phosphor::hwmon::ReadPool pool(event, io, 2, []() {});
+        ASSERT_TRUE(pool.submit(attributes, values, errors));
+    }
+    EXPECT_EQ(attributes.size(), values.size());
+
+    sd_event_unref(event);
+}
@@ -0,0 +1,167 @@
+#include "config.h"
+#include "sensorconfig.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+TEST(SensorConfigTest, SensorSettings)
+{
+    env::Settings settings{
+        {"LABEL_temp1", "ambient"},
+        {"GAIN_temp1", "0.5"},
+        {"OFFSET_temp1", "-1000"},
+        {"REMOVERCS_temp1", "6, 110"},
+        {"WARNLO_temp1", "-5000"},
+        {"WARNHI_temp1", "40000"},
+        {"PWM_TARGET_fan1", "3"},
+        {"ENABLE_fan1", "2"},
+        {"DEADBAND_in0", "5%"},
+        {"WARNHYST_temp1", "1000"},
+        {"DEBOUNCE_temp1", "2/3"},
+        {"PATH", "/usr/bin"},
+    };
+
+    auto device = config::parse(settings);
+    EXPECT_TRUE(device.errors.empty());
+
+    auto& temp1 = device.sensor("temp", "1");
+    EXPECT_EQ("ambient", temp1.label);
+    EXPECT_EQ(0.5, temp1.gain);
+    EXPECT_EQ(-1000, temp1.offset);
+    EXPECT_EQ(2u, temp1.removeRCs.size());
+    EXPECT_EQ(1u, temp1.removeRCs.count(110));
+    EXPECT_EQ(-5000, *temp1.warnLo);
+    EXPECT_EQ(40000, *temp1.warnHi);
+    EXPECT_FALSE(temp1.critLo);
+    EXPECT_EQ(1000, *temp1.warnHyst);
+    EXPECT_FALSE(temp1.critHyst);
+    EXPECT_EQ(2, temp1.debounce->count);
+    EXPECT_EQ(3, temp1.debounce->window);
+
+    auto& fan1 = device.sensor(SensorSet::key_type{"fan", "1"});
+    EXPECT_EQ("3", fan1.pwmTarget);
+    EXPECT_EQ(2u, *fan1.enable);
+
+    auto& in0 = device.sensor("in", "0");
+    EXPECT_TRUE(in0.deadband->relative);
+    EXPECT_EQ(5, in0.deadband->band);
+}
+
+TEST(SensorConfigTest, DeviceSettings)
+{
+    env::Settings settings{
+        {"INTERVAL", "500000"},
+        {"INTERVAL_temp1", "2000000"},
+        {"REMOVERCS", "6"},
+        {"TARGET_MODE", "pwm"},
+        {"COALESCE_SIGNALS", "1"},
+        {"ALARM_EVENTS", "0"},
+        {"CHIP_THRESHOLDS", "1"},
+        {"SENSOR_TABLE", "1"},
+        {"READ_THREADS", "4"},
+        {"HISTORY", "60"},
+        {"HISTORY_temp1", "0"},
+        {"STAT_WINDOWS", "10, 60"},
+        {"SNAPSHOT_INTERVAL", "10000000"},
+        {"SNAPSHOT_MAX_AGE", "30000000"},
+    };
+
+    auto device = config::parse(settings);
+    EXPECT_TRUE(device.errors.empty());
+    EXPECT_EQ(500000u, *device.interval);
+    EXPECT_EQ(2000000u, *device.sensor("temp", "1").interval);
+    EXPECT_EQ(1u, device.removeRCs.count(6));
+    EXPECT_EQ(targetType::PWM, device.targetMode);
+    EXPECT_TRUE(device.coalesceSignals);
+    EXPECT_FALSE(device.alarmEvents);
+    EXPECT_TRUE(device.chipThresholds);
+    EXPECT_TRUE(device.sensorTable);
+    EXPECT_EQ(4u, device.readThreads);
+    EXPECT_EQ(60u, *device.history);
+    EXPECT_EQ(0u, *device.sensor("temp", "1").history);
+    EXPECT_EQ((std::vector<size_t>{10, 60}), device.statWindows);
+    EXPECT_EQ(10000000u, device.snapshotInterval);
+    EXPECT_EQ(30000000u, *device.snapshotMaxAge);
+
+    // Restart snapshots are only taken when asked for.
+    EXPECT_EQ(0u, config::parse({}).snapshotInterval);
+}
+
+TEST(SensorConfigTest, InvalidSettings)
+{
+    env::Settings settings{
+        {"GAIN_temp1", "half"},
+        {"WARNHI_temp1", "40C"},
+        {"TARGET_MODE", "both"},
+        {"HEARTBEAT", "-1"},
+        {"LABEL_temp2", ""},
+        {"CRITHYST_temp1", "-1"},
+        {"DEBOUNCE", "4/3"},
+        {"HISTORY_temp1", "65537"},
+        {"STAT_WINDOWS", "10,0"},
+    };
+
+    auto device = config::parse(settings);
+    EXPECT_EQ(8u, device.errors.size());
+    EXPECT_NE(device.errors.end(),
+              std::find(device.errors.begin(), device.errors.end(),
+                        "WARNHI_temp1=40C"));
+
+    // Invalid and empty settings are left at their defaults.
+    auto& temp1 = device.sensor("temp", "1");
+    EXPECT_EQ(1.0, temp1.gain);
+    EXPECT_FALSE(temp1.warnHi);
+    EXPECT_EQ(targetType::DEFAULT, device.targetMode);
+    EXPECT_FALSE(device.heartbeat);
+    EXPECT_FALSE(temp1.history);
+    EXPECT_TRUE(device.statWindows.empty());
+    EXPECT_TRUE(device.sensor("temp", "2").label.empty());
+}
+
+#ifdef ENABLE_CONFIG_FILE
+TEST(SensorConfigTest, JsonSettings)
+{
+    char tmpl[] = "/tmp/sensorconfig_unittest.XXXXXX";
+    auto fd = mkstemp(tmpl);
+    ASSERT_NE(-1, fd);
+    close(fd);
+
+    {
+        std::ofstream ofs(tmpl);
+        ofs << R"({
+            "INTERVAL": 500000,
+            "REMOVERCS": [6, 110],
+            "COALESCE_SIGNALS": true,
+            "sensors": {
+                "temp1": { "LABEL": "ambient", "GAIN": 0.5 }
+            }
+        })";
+    }
+
+    env::Settings settings{
+        {"INTERVAL", "1000000"},
+        {"LABEL_temp1", "inlet"},
+        {"LABEL_temp2", "outlet"},
+    };
+    EXPECT_TRUE(config::loadJson(tmpl, settings));
+    std::remove(tmpl);
+
+    // The file takes precedence over the environment.
+    auto device = config::parse(settings);
+    EXPECT_TRUE(device.errors.empty());
+    EXPECT_EQ(500000u, *device.interval);
+    EXPECT_EQ(2u, device.removeRCs.size());
+    EXPECT_TRUE(device.coalesceSignals);
+    EXPECT_EQ("ambient", device.sensor("temp", "1").label);
+    EXPECT_EQ(0.5, device.sensor("temp", "1").gain);
+    EXPECT_EQ("outlet", device.sensor("temp", "2").label);
+
+    EXPECT_FALSE(config::loadJson("/nonexistent/sensorconfig.json",
+                                  settings));
+}
+#endif
@@ -0,0 +1,72 @@
+#include "sensorset.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+class SensorSetTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char tmpl[] = "/tmp/sensorset_unittest.XXXXXX";
+            ASSERT_NE(nullptr, mkdtemp(tmpl));
+            dir = tmpl;
+
+            for (const auto& f : files)
+            {
+                std::ofstream{dir + '/' + f};
+            }
+        }
+
+        void TearDown() override
+        {
+            for (const auto& f : files)
+            {
+                unlink((dir + '/' + f).c_str());
+            }
+            rmdir(dir.c_str());
+        }
+
+        std::string dir;
+        const std::vector<std::string> files{
+            "name", "uevent", "update_interval",
+            "temp1_input", "temp1_label", "temp1_max", "temp1_max_alarm",
+            "temp1_crit_hyst", "temp1_auto_point1_pwm",
+            "humidity2_input", "intrusion0_alarm", "pwm1", "pwm1_enable",
+            "in0_input", "bogus3_input", "temp_input", "fan1x_input",
+        };
+};
+
+TEST_F(SensorSetTest, AllAttributes)
+{
+    SensorSet sensors(dir);
+
+    auto temp1 = sensors.find({"temp", "1"});
+    ASSERT_NE(sensors.end(), temp1);
+    EXPECT_EQ((SensorSet::mapped_type{"input", "max", "max_alarm",
+                                      "crit_hyst", "auto_point1_pwm"}),
+              temp1->second);
+
+    auto pwm1 = sensors.find({"pwm", "1"});
+    ASSERT_NE(sensors.end(), pwm1);
+    EXPECT_EQ((SensorSet::mapped_type{"", "enable"}), pwm1->second);
+
+    EXPECT_NE(sensors.end(), sensors.find({"humidity", "2"}));
+    EXPECT_NE(sensors.end(), sensors.find({"intrusion", "0"}));
+    EXPECT_NE(sensors.end(), sensors.find({"in", "0"}));
+
+    // Unknown types and malformed names aren't sensors.
+    EXPECT_EQ(5, std::distance(sensors.begin(), sensors.end()));
+}
+
+TEST(SensorSetErrorTest, MissingDirectory)
+{
+    EXPECT_THROW(SensorSet("/nonexistent/hwmon0"), std::system_error);
+}
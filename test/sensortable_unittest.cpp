@@ -0,0 +1,136 @@
+#include "sensortable.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace phosphor::hwmon;
+
+class SensorTableTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char tmpl[] = "/tmp/sensortable_unittest.XXXXXX";
+            auto fd = mkstemp(tmpl);
+            ASSERT_NE(-1, fd);
+            close(fd);
+            path = tmpl;
+        }
+
+        void TearDown() override
+        {
+            std::remove(path.c_str());
+        }
+
+        /** @brief Read the table as a reader would. */
+        std::vector<table::Record> read(table::Header& header)
+        {
+            std::vector<table::Record> records(table::capacity);
+
+            auto fd = open(path.c_str(), O_RDONLY);
+            EXPECT_NE(-1, fd);
+            auto addr = mmap(nullptr, table::size, PROT_READ, MAP_SHARED,
+                             fd, 0);
+            close(fd);
+            EXPECT_NE(MAP_FAILED, addr);
+
+            auto mapped = static_cast<const table::Header*>(addr);
+            size_t count = 0;
+            EXPECT_TRUE(table::read(mapped, records.data(), count));
+            records.resize(count);
+            header = *mapped;
+            munmap(addr, table::size);
+
+            return records;
+        }
+
+        std::string path;
+};
+
+TEST_F(SensorTableTest, Layout)
+{
+    {
+        SensorTable t(path);
+        EXPECT_EQ(0u, t.add("temp1", "/xyz/openbmc_project/sensors/a"));
+        EXPECT_EQ(1u, t.add("fan1", "/xyz/openbmc_project/sensors/b"));
+        EXPECT_EQ(0u, t.add("temp1", "/xyz/openbmc_project/sensors/a"));
+
+        t.begin();
+        t.update(1, 4000, table::FUNCTIONAL, table::WARN_HI);
+        t.stamp(1, 123);
+        t.end();
+
+        table::Header header;
+        auto records = read(header);
+        EXPECT_EQ(table::magic, header.magic);
+        EXPECT_EQ(table::version, header.version);
+        EXPECT_EQ(sizeof(table::Record), header.recordSize);
+        EXPECT_EQ(0u, header.sequence & 1);
+        EXPECT_EQ(static_cast<uint64_t>(getpid()), header.writer);
+
+        ASSERT_EQ(2u, records.size());
+        EXPECT_STREQ("temp1", records[0].name);
+        EXPECT_EQ(table::PRESENT, records[0].status);
+        EXPECT_STREQ("fan1", records[1].name);
+        EXPECT_STREQ("/xyz/openbmc_project/sensors/b", records[1].path);
+        EXPECT_EQ(4000, records[1].value);
+        EXPECT_EQ(123u, records[1].time);
+        EXPECT_EQ(table::PRESENT | table::FUNCTIONAL, records[1].status);
+        EXPECT_EQ(table::WARN_HI, records[1].alarms);
+    }
+
+    table::Header header;
+    auto records = read(header);
+    EXPECT_EQ(0u, header.writer);
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ(0u, records[1].status & table::PRESENT);
+}
+
+TEST_F(SensorTableTest, StableIds)
+{
+    {
+        SensorTable t(path);
+        t.add("temp1", "/a");
+        t.add("temp2", "/b");
+    }
+
+    // The ids survive a restart, even for sensors added in another order.
+    SensorTable t(path);
+    EXPECT_EQ(1u, t.add("temp2", "/b"));
+    EXPECT_EQ(2u, t.add("temp3", "/c"));
+
+    t.begin();
+    t.clear();
+    EXPECT_EQ(2u, t.add("temp3", "/c"));
+    t.end();
+
+    table::Header header;
+    auto records = read(header);
+    ASSERT_EQ(3u, records.size());
+    EXPECT_EQ(0u, records[0].status & table::PRESENT);
+    EXPECT_EQ(0u, records[1].status & table::PRESENT);
+    EXPECT_EQ(table::PRESENT, records[2].status);
+}
+
+TEST_F(SensorTableTest, Replaced)
+{
+    {
+        FILE* f = fopen(path.c_str(), "w");
+        ASSERT_NE(nullptr, f);
+        fputs("not a table", f);
+        fclose(f);
+    }
+
+    SensorTable t(path);
+    EXPECT_EQ(0u, t.add("in0", "/a"));
+
+    table::Header header;
+    EXPECT_EQ(1u, read(header).size());
+    EXPECT_EQ(table::capacity, header.capacity);
+}
@@ -0,0 +1,129 @@
+#include "snapshot.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+using namespace phosphor::hwmon;
+
+class SnapshotTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            char tmpl[] = "/tmp/snapshot_unittest.XXXXXX";
+            auto fd = mkstemp(tmpl);
+            ASSERT_NE(-1, fd);
+            close(fd);
+            path = tmpl;
+        }
+
+        void TearDown() override
+        {
+            std::remove(path.c_str());
+        }
+
+        /** @brief A time in this boot, in microseconds. */
+        snapshot::Stamp stamp(uint64_t time)
+        {
+            snapshot::Stamp s;
+            s.boot = "0f3c5b8e-1a2d-4e6f-9b7c-2d4e6f8a0b1c";
+            s.time = time;
+            return s;
+        }
+
+        static constexpr std::chrono::microseconds maxAge{10000};
+        std::string path;
+};
+
+constexpr std::chrono::microseconds SnapshotTest::maxAge;
+
+TEST_F(SnapshotTest, RoundTrip)
+{
+    std::vector<snapshot::Entry> entries(2);
+    entries[0].type = "temp";
+    entries[0].id = "1";
+    entries[0].attributes = {"input", "label"};
+    entries[0].path = "/xyz/openbmc_project/sensors/temperature/ambient";
+    entries[0].value = -2500;
+    entries[1].type = "fan";
+    entries[1].id = "3";
+    entries[1].attributes = {"input", "fault"};
+    entries[1].path = "/xyz/openbmc_project/sensors/fan_tach/fan3";
+    entries[1].value = 9000;
+    entries[1].functional = false;
+
+    ASSERT_TRUE(snapshot::save(path, entries, stamp(1000)));
+    auto loaded = snapshot::load(path, maxAge, stamp(1500));
+
+    ASSERT_EQ(2u, loaded.size());
+    EXPECT_EQ("temp", loaded[0].type);
+    EXPECT_EQ("1", loaded[0].id);
+    EXPECT_EQ(entries[0].attributes, loaded[0].attributes);
+    EXPECT_EQ(entries[0].path, loaded[0].path);
+    EXPECT_EQ(-2500, loaded[0].value);
+    EXPECT_TRUE(loaded[0].functional);
+    EXPECT_EQ("fan", loaded[1].type);
+    EXPECT_EQ(9000, loaded[1].value);
+    EXPECT_FALSE(loaded[1].functional);
+}
+
+TEST_F(SnapshotTest, Truncated)
+{
+    std::vector<snapshot::Entry> entries(1);
+    entries[0].type = "in";
+    entries[0].id = "0";
+    entries[0].path = "/xyz/openbmc_project/sensors/voltage/p12v";
+    ASSERT_TRUE(snapshot::save(path, entries, stamp(1000)));
+
+    std::string buf;
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        buf.assign(std::istreambuf_iterator<char>(ifs),
+                   std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs.write(buf.data(), buf.size() - 1);
+    }
+
+    EXPECT_TRUE(snapshot::load(path, maxAge, stamp(1000)).empty());
+}
+
+TEST_F(SnapshotTest, Missing)
+{
+    std::remove(path.c_str());
+    EXPECT_TRUE(snapshot::load(path, maxAge, stamp(1000)).empty());
+}
+
+TEST_F(SnapshotTest, OutOfDate)
+{
+    std::vector<snapshot::Entry> entries(1);
+    entries[0].type = "temp";
+    entries[0].id = "1";
+    ASSERT_TRUE(snapshot::save(path, entries, stamp(1000)));
+
+    EXPECT_EQ(1u, snapshot::load(path, maxAge, stamp(11000)).size());
+    EXPECT_TRUE(snapshot::load(path, maxAge, stamp(11001)).empty());
+
+    auto other = stamp(1000);
+    other.boot = "6b5a4c36-5d4e-4b1d-8f6c-3c2d1e0f9a8b";
+    EXPECT_TRUE(snapshot::load(path, maxAge, other).empty());
+
+    // Without a boot id, no snapshot can be trusted.
+    auto unknown = stamp(1000);
+    unknown.boot.clear();
+    ASSERT_TRUE(snapshot::save(path, entries, unknown));
+    EXPECT_TRUE(snapshot::load(path, maxAge, unknown).empty());
+}
+
+TEST_F(SnapshotTest, Now)
+{
+    std::vector<snapshot::Entry> entries(1);
+    ASSERT_TRUE(snapshot::save(path, entries));
+    EXPECT_EQ(1u, snapshot::load(path, std::chrono::seconds(60)).size());
+}
@@ -0,0 +1,106 @@
+#include "timerwheel.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+using phosphor::hwmon::TimerWheel;
+
+static std::vector<size_t> advance(TimerWheel& wheel)
+{
+    std::vector<size_t> due;
+    wheel.advance(due);
+    std::sort(due.begin(), due.end());
+    return due;
+}
+
+TEST(TimerWheelTest, DueOnFirstTick)
+{
+    TimerWheel wheel(8);
+    wheel.add(0, 1);
+    wheel.add(1, 5);
+
+    EXPECT_EQ(std::vector<size_t>({0, 1}), advance(wheel));
+}
+
+TEST(TimerWheelTest, Periods)
+{
+    TimerWheel wheel(4);
+    wheel.add(0, 1);
+    wheel.add(1, 3);
+    wheel.add(2, 10);
+
+    std::vector<std::vector<size_t>> expected(21);
+    for (uint64_t t = 0; t < expected.size(); ++t)
+    {
+        expected[t].push_back(0);
+        if (t % 3 == 0)
+        {
+            expected[t].push_back(1);
+        }
+        if (t % 10 == 0)
+        {
+            expected[t].push_back(2);
+        }
+    }
+
+    for (auto& e : expected)
+    {
+        EXPECT_EQ(e, advance(wheel));
+    }
+}
+
+TEST(TimerWheelTest, PeriodMultipleOfSize)
+{
+    TimerWheel wheel(4);
+    wheel.add(7, 8);
+
+    EXPECT_EQ(std::vector<size_t>({7}), advance(wheel));
+    for (auto i = 0; i < 7; ++i)
+    {
+        EXPECT_TRUE(advance(wheel).empty());
+    }
+    EXPECT_EQ(std::vector<size_t>({7}), advance(wheel));
+}
+
+TEST(TimerWheelTest, Clear)
+{
+    TimerWheel wheel(4);
+    wheel.add(0, 1);
+    wheel.clear();
+
+    EXPECT_TRUE(advance(wheel).empty());
+}
+
+TEST(TimerWheelTest, Remaining)
+{
+    TimerWheel wheel(4);
+    wheel.add(0, 3);
+    wheel.add(1, 10);
+    wheel.add(2, 4, 6);
+    advance(wheel);
+    advance(wheel);
+
+    std::vector<uint64_t> delays(2, 0);
+    wheel.remaining(delays);
+    EXPECT_EQ(std::vector<uint64_t>({2, 9}), delays);
+
+    // Rebuilt with the remaining delays, the entries keep their phase.
+    delays.resize(3);
+    wheel.remaining(delays);
+    wheel.clear();
+    wheel.add(0, 3, delays[0]);
+    wheel.add(1, 10, delays[1]);
+    wheel.add(2, 4, delays[2]);
+
+    EXPECT_TRUE(advance(wheel).empty());
+    EXPECT_EQ(std::vector<size_t>({0}), advance(wheel));
+    EXPECT_TRUE(advance(wheel).empty());
+    EXPECT_EQ(std::vector<size_t>({2}), advance(wheel));
+    EXPECT_EQ(std::vector<size_t>({0}), advance(wheel));
+    EXPECT_TRUE(advance(wheel).empty());
+    EXPECT_TRUE(advance(wheel).empty());
+    EXPECT_EQ(std::vector<size_t>({0, 2}), advance(wheel));
+    EXPECT_EQ(std::vector<size_t>({1}), advance(wheel));
+}
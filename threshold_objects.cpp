@@ -0,0 +1,50 @@
+#include "threshold_objects.hpp"
+
+namespace hwmon
+{
+
+int64_t WarningThreshold::warningLow(int64_t value)
+{
+    auto old = WarningObject::warningLow();
+    auto result = WarningObject::warningLow(value);
+    if (result != old && changed)
+    {
+        changed(false);
+    }
+    return result;
+}
+
+int64_t WarningThreshold::warningHigh(int64_t value)
+{
+    auto old = WarningObject::warningHigh();
+    auto result = WarningObject::warningHigh(value);
+    if (result != old && changed)
+    {
+        changed(true);
+    }
+    return result;
+}
+
+int64_t CriticalThreshold::criticalLow(int64_t value)
+{
+    auto old = CriticalObject::criticalLow();
+    auto result = CriticalObject::criticalLow(value);
+    if (result != old && changed)
+    {
+        changed(false);
+    }
+    return result;
+}
+
+int64_t CriticalThreshold::criticalHigh(int64_t value)
+{
+    auto old = CriticalObject::criticalHigh();
+    auto result = CriticalObject::criticalHigh(value);
+    if (result != old && changed)
+    {
+        changed(true);
+    }
+    return result;
+}
+
+} // namespace hwmon
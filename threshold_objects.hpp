@@ -0,0 +1,122 @@
+#pragma once
+
+#include <functional>
+
+#include "interface.hpp"
+
+namespace hwmon
+{
+
+/**
+ * @class WarningThreshold
+ * @brief Warning thresholds that report changes to their limits
+ * @details Derived WarningObject type that calls back when warningLow or
+ * warningHigh is set, so the alarms can be evaluated again at once.
+ */
+class WarningThreshold : public WarningObject
+{
+    public:
+
+        /**
+         * @brief Constructs WarningThreshold Object
+         *
+         * @param[in] bus - Dbus bus object
+         * @param[in] objPath - Dbus object path
+         * @param[in] defer - Dbus object registration defer
+         */
+        WarningThreshold(sdbusplus::bus::bus& bus,
+                         const char* objPath,
+                         bool defer) : WarningObject(bus, objPath, defer)
+        {
+        }
+
+        using WarningObject::warningLow;
+        using WarningObject::warningHigh;
+
+        /**
+         * @brief Set the value of warningLow
+         *
+         * @return Value of warningLow
+         */
+        int64_t warningLow(int64_t value) override;
+
+        /**
+         * @brief Set the value of warningHigh
+         *
+         * @return Value of warningHigh
+         */
+        int64_t warningHigh(int64_t value) override;
+
+        /**
+         * @brief Set the function called when a limit changes
+         *
+         * @param[in] callback - The function, empty for none, called
+         *                       with whether it's the high limit
+         */
+        void onChange(std::function<void(bool)> callback)
+        {
+            changed = std::move(callback);
+        }
+
+    private:
+        /** @brief Called when a limit changes. */
+        std::function<void(bool)> changed;
+};
+
+/**
+ * @class CriticalThreshold
+ * @brief Critical thresholds that report changes to their limits
+ * @details Derived CriticalObject type that calls back when criticalLow
+ * or criticalHigh is set, so the alarms can be evaluated again at once.
+ */
+class CriticalThreshold : public CriticalObject
+{
+    public:
+
+        /**
+         * @brief Constructs CriticalThreshold Object
+         *
+         * @param[in] bus - Dbus bus object
+         * @param[in] objPath - Dbus object path
+         * @param[in] defer - Dbus object registration defer
+         */
+        CriticalThreshold(sdbusplus::bus::bus& bus,
+                          const char* objPath,
+                          bool defer) : CriticalObject(bus, objPath, defer)
+        {
+        }
+
+        using CriticalObject::criticalLow;
+        using CriticalObject::criticalHigh;
+
+        /**
+         * @brief Set the value of criticalLow
+         *
+         * @return Value of criticalLow
+         */
+        int64_t criticalLow(int64_t value) override;
+
+        /**
+         * @brief Set the value of criticalHigh
+         *
+         * @return Value of criticalHigh
+         */
+        int64_t criticalHigh(int64_t value) override;
+
+        /**
+         * @brief Set the function called when a limit changes
+         *
+         * @param[in] callback - The function, empty for none, called
+         *                       with whether it's the high limit
+         */
+        void onChange(std::function<void(bool)> callback)
+        {
+            changed = std::move(callback);
+        }
+
+    private:
+        /** @brief Called when a limit changes. */
+        std::function<void(bool)> changed;
+};
+
+} // namespace hwmon
@@ -1,6 +1,7 @@
 #pragma once
 
-#include "env.hpp"
+#include "sensorconfig.hpp"
+#include "threshold_objects.hpp"
 
 /** @class Thresholds
  *  @brief Threshold type traits.
@@ -20,30 +21,46 @@ struct Thresholds
 template <>
 struct Thresholds<WarningObject>
 {
+    static constexpr const char* interface =
+        "xyz.openbmc_project.Sensor.Threshold.Warning";
+    static constexpr const char* alarmLoProperty = "WarningAlarmLow";
+    static constexpr const char* alarmHiProperty = "WarningAlarmHigh";
     static constexpr InterfaceType type = InterfaceType::WARN;
-    static constexpr const char* envLo = "WARNLO";
-    static constexpr const char* envHi = "WARNHI";
+    using Server = hwmon::WarningThreshold;
+    static config::optional<int64_t> config::Sensor::*const configLo;
+    static config::optional<int64_t> config::Sensor::*const configHi;
+    static config::optional<int64_t> config::Sensor::*const configHyst;
     static int64_t (WarningObject::*const setLo)(int64_t);
     static int64_t (WarningObject::*const setHi)(int64_t);
     static int64_t (WarningObject::*const getLo)() const;
     static int64_t (WarningObject::*const getHi)() const;
-    static bool (WarningObject::*const alarmLo)(bool);
-    static bool (WarningObject::*const alarmHi)(bool);
+    static bool (WarningObject::*const alarmLo)(bool, bool);
+    static bool (WarningObject::*const alarmHi)(bool, bool);
+    static bool (WarningObject::*const getAlarmLo)() const;
+    static bool (WarningObject::*const getAlarmHi)() const;
 };
 
 /**@brief Thresholds specialization for critical thresholds. */
 template <>
 struct Thresholds<CriticalObject>
 {
+    static constexpr const char* interface =
+        "xyz.openbmc_project.Sensor.Threshold.Critical";
+    static constexpr const char* alarmLoProperty = "CriticalAlarmLow";
+    static constexpr const char* alarmHiProperty = "CriticalAlarmHigh";
     static constexpr InterfaceType type = InterfaceType::CRIT;
-    static constexpr const char* envLo = "CRITLO";
-    static constexpr const char* envHi = "CRITHI";
+    using Server = hwmon::CriticalThreshold;
+    static config::optional<int64_t> config::Sensor::*const configLo;
+    static config::optional<int64_t> config::Sensor::*const configHi;
+    static config::optional<int64_t> config::Sensor::*const configHyst;
     static int64_t (CriticalObject::*const setLo)(int64_t);
     static int64_t (CriticalObject::*const setHi)(int64_t);
     static int64_t (CriticalObject::*const getLo)() const;
     static int64_t (CriticalObject::*const getHi)() const;
-    static bool (CriticalObject::*const alarmLo)(bool);
-    static bool (CriticalObject::*const alarmHi)(bool);
+    static bool (CriticalObject::*const alarmLo)(bool, bool);
+    static bool (CriticalObject::*const alarmHi)(bool, bool);
+    static bool (CriticalObject::*const getAlarmLo)() const;
+    static bool (CriticalObject::*const getAlarmHi)() const;
 };
 
 /** @brief checkThresholds
@@ -51,58 +68,160 @@ struct Thresholds<CriticalObject>
  *  Compare a sensor reading to threshold values and set the
  *  appropriate alarm property if bounds are exceeded.
  *
+ *  The alarm properties are set without signalling, it's up to the
+ *  caller to signal the changes it's told about.
+ *
  *  @tparam T - The threshold type.
  *
  *  @param[in] iface - An sdbusplus server threshold instance.
  *  @param[in] value - The sensor reading to compare to thresholds.
+ *  @param[in] hardware - Low and high alarms raised by the hardware,
+ *                        only used for the alarms left to it.
+ *  @param[in] chip - Whether the low and high alarms are left to the
+ *                    hardware alone, without comparing the reading.
+ *  @param[in] filter - The reading's filtered alarms, from
+ *                      sampleThresholds(), used instead of comparing
+ *                      the reading.
+ *
+ *  @return Whether the low and high alarms changed.
+ */
+template <typename T>
+std::pair<bool, bool> checkThresholds(
+        T& iface,
+        int64_t value,
+        std::pair<bool, bool> hardware = {},
+        std::pair<bool, bool> chip = {},
+        const hwmon::AlarmFilter* filter = nullptr)
+{
+    static constexpr auto skipSignal = true;
+
+    auto lo = (iface.*Thresholds<T>::getLo)();
+    auto hi = (iface.*Thresholds<T>::getHi)();
+    auto software = filter ? filter->alarms() :
+                             std::make_pair(value <= lo, value >= hi);
+    auto alarmLo = chip.first ? hardware.first : software.first;
+    auto alarmHi = chip.second ? hardware.second : software.second;
+
+    auto changed = std::make_pair(
+            (iface.*Thresholds<T>::getAlarmLo)() != alarmLo,
+            (iface.*Thresholds<T>::getAlarmHi)() != alarmHi);
+
+    (iface.*Thresholds<T>::alarmLo)(alarmLo, skipSignal);
+    (iface.*Thresholds<T>::alarmHi)(alarmHi, skipSignal);
+
+    return changed;
+}
+
+/** @brief sampleThresholds
+ *
+ *  Add a sensor reading to the samples of a threshold's alarm filter.
+ *
+ *  @tparam T - The threshold type.
+ *
+ *  @param[in] iface - An sdbusplus server threshold instance.
+ *  @param[in,out] filter - The threshold's alarm filter.
+ *  @param[in] value - The sensor reading.
  */
 template <typename T>
-void checkThresholds(std::experimental::any& iface, int64_t value)
+void sampleThresholds(const T& iface,
+                      hwmon::AlarmFilter& filter,
+                      int64_t value)
 {
-    auto realIface = std::experimental::any_cast<std::shared_ptr<T>>
-                     (iface);
-    auto lo = (*realIface.*Thresholds<T>::getLo)();
-    auto hi = (*realIface.*Thresholds<T>::getHi)();
-    (*realIface.*Thresholds<T>::alarmLo)(value <= lo);
-    (*realIface.*Thresholds<T>::alarmHi)(value >= hi);
+    filter.sample(value,
+                  (iface.*Thresholds<T>::getLo)(),
+                  (iface.*Thresholds<T>::getHi)());
+}
+
+/** @brief rebaseThresholds
+ *
+ *  Decide the alarm of a threshold's changed limit from a reading,
+ *  for when the limit changes.
+ *
+ *  @tparam T - The threshold type.
+ *
+ *  @param[in] iface - An sdbusplus server threshold instance.
+ *  @param[in,out] filter - The threshold's alarm filter.
+ *  @param[in] value - The sensor reading.
+ *  @param[in] high - Whether the high limit changed, else the low.
+ */
+template <typename T>
+void rebaseThresholds(const T& iface,
+                      hwmon::AlarmFilter& filter,
+                      int64_t value,
+                      bool high)
+{
+    filter.rebase(value,
+                  high ? (iface.*Thresholds<T>::getHi)() :
+                         (iface.*Thresholds<T>::getLo)(),
+                  high);
+}
+
+/** @brief resetThresholds
+ *
+ *  Set up a threshold's alarm filter, starting from its alarms.
+ *
+ *  @tparam T - The threshold type.
+ *
+ *  @param[in] iface - An sdbusplus server threshold instance.
+ *  @param[out] filter - The threshold's alarm filter.
+ *  @param[in] config - The sensor's settings, for the hysteresis.
+ *  @param[in] debounce - The alarms' debounce.
+ */
+template <typename T>
+void resetThresholds(const T& iface,
+                     hwmon::AlarmFilter& filter,
+                     const config::Sensor& config,
+                     const hwmon::Debounce& debounce)
+{
+    filter.hysteresis = (config.*Thresholds<T>::configHyst).value_or(0);
+    filter.debounce = debounce;
+    filter.reset((iface.*Thresholds<T>::getAlarmLo)(),
+                 (iface.*Thresholds<T>::getAlarmHi)());
 }
 
 /** @brief addThreshold
  *
- *  Look for a configured threshold value in the environment and
+ *  Look for configured threshold values in the sensor's settings and
  *  create an sdbusplus server threshold if found.
  *
  *  @tparam T - The threshold type.
+ *  @tparam U - The type of the threshold object, derived from
+ *             Thresholds<T>::Server.
  *
- *  @param[in] sensorType - sensor type, like 'temp'
- *  @param[in] sensorID - sensor ID, like '5'
+ *  @param[in] config - The sensor's settings.
  *  @param[in] value - The sensor reading.
  *  @param[in] info - The sdbusplus server connection and interfaces.
+ *  @param[in] args - Constructor arguments of U, before the bus, path
+ *                    and defer arguments.
  */
-template <typename T>
-auto addThreshold(const std::string& sensorType,
-                  const std::string& sensorID,
+template <typename T,
+          typename U = typename Thresholds<T>::Server,
+          typename... Args>
+auto addThreshold(const config::Sensor& config,
                   int64_t value,
-                  ObjectInfo& info)
+                  ObjectInfo& info,
+                  Args&&... args)
 {
     static constexpr bool deferSignals = true;
+    static constexpr bool skipSignal = false;
 
     auto& bus = *std::get<sdbusplus::bus::bus*>(info);
     auto& objPath = std::get<std::string>(info);
     auto& obj = std::get<Object>(info);
     std::shared_ptr<T> iface;
 
-    auto tLo = env::getEnv(Thresholds<T>::envLo, sensorType, sensorID);
-    auto tHi = env::getEnv(Thresholds<T>::envHi, sensorType, sensorID);
-    if (!tLo.empty() && !tHi.empty())
+    auto& tLo = config.*Thresholds<T>::configLo;
+    auto& tHi = config.*Thresholds<T>::configHi;
+    if (tLo && tHi)
     {
-        iface = std::make_shared<T>(bus, objPath.c_str(), deferSignals);
-        auto lo = stoll(tLo);
-        auto hi = stoll(tHi);
+        iface = std::make_shared<U>(std::forward<Args>(args)...,
+                                    bus, objPath.c_str(), deferSignals);
+        auto lo = *tLo;
+        auto hi = *tHi;
         (*iface.*Thresholds<T>::setLo)(lo);
         (*iface.*Thresholds<T>::setHi)(hi);
-        (*iface.*Thresholds<T>::alarmLo)(value <= lo);
-        (*iface.*Thresholds<T>::alarmHi)(value >= hi);
+        (*iface.*Thresholds<T>::alarmLo)(value <= lo, skipSignal);
+        (*iface.*Thresholds<T>::alarmHi)(value >= hi, skipSignal);
         auto type = Thresholds<T>::type;
         obj[type] = iface;
     }
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <chrono>
 #include <system_error>
 #include <string.h>
@@ -36,6 +37,36 @@ Timer::Timer(sd_event* event,
     }
 }
 
+void Timer::start(std::chrono::microseconds usec, timer::Action action)
+{
+    duration = usec;
+    this->action = action;
+
+    auto r = sd_event_source_set_time(eventSource, (getTime() + usec).count());
+    if (r < 0)
+    {
+        throw std::system_error(r, std::generic_category(), strerror(-r));
+    }
+    r = sd_event_source_set_enabled(eventSource, action);
+    if (r < 0)
+    {
+        throw std::system_error(r, std::generic_category(), strerror(-r));
+    }
+}
+
+void Timer::fixedRate()
+{
+    fixed = true;
+
+    // The default accuracy lets sd-event coalesce wakeups up to 250ms
+    // late, which defeats the point of keeping to the deadlines.
+    auto r = sd_event_source_set_time_accuracy(eventSource, 1);
+    if (r < 0)
+    {
+        throw std::system_error(r, std::generic_category(), strerror(-r));
+    }
+}
+
 int Timer::timeoutHandler(sd_event_source* eventSource,
                           uint64_t usec, void* userData)
 {
@@ -43,8 +74,28 @@ int Timer::timeoutHandler(sd_event_source* eventSource,
 
     if (timer->getAction() == timer::ON)
     {
-        auto r = sd_event_source_set_time(
-                     eventSource, (getTime() + timer->getDuration()).count());
+        auto now = getTime();
+        auto next = now + timer->getDuration();
+
+        if (timer->fixed)
+        {
+            // usec is the deadline that expired.
+            auto deadline = std::chrono::microseconds(usec);
+            auto period = timer->getDuration();
+
+            timer->lateness = std::max(
+                    now - deadline, std::chrono::microseconds::zero());
+            timer->missed = 0;
+
+            next = deadline + period;
+            if (next <= now && period.count() > 0)
+            {
+                timer->missed = (now - deadline) / period;
+                next = deadline + (timer->missed + 1) * period;
+            }
+        }
+
+        auto r = sd_event_source_set_time(eventSource, next.count());
         if (r < 0)
         {
             throw std::system_error(r, std::generic_category(), strerror(-r));
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <systemd/sd-event.h>
 
@@ -77,6 +78,35 @@ class Timer
             return sd_event_source_set_enabled(eventSource, action);
         }
 
+        /** @brief Re-arms the timer to expire after a new duration
+         *
+         *  @param[in] usec - timer duration from now, in micro seconds
+         *  @param[in] action - controls the timer's lifetime
+         */
+        void start(std::chrono::microseconds usec, timer::Action action);
+
+        /** @brief Switches a repeating timer to fixed rate
+         *
+         *  Each expiry is scheduled a duration after the previous
+         *  deadline, rather than a duration after it was handled, so
+         *  the period does not drift with scheduling latency.  Deadlines
+         *  that have already passed are skipped and counted instead of
+         *  firing back to back.
+         */
+        void fixedRate();
+
+        /** @brief How late the last expiry was handled */
+        std::chrono::microseconds getLateness() const
+        {
+            return lateness;
+        }
+
+        /** @brief Deadlines skipped before the last expiry */
+        uint64_t getMissed() const
+        {
+            return missed;
+        }
+
         timer::Action getAction() const
         {
             return action;
@@ -102,6 +132,15 @@ class Timer
 
         /** @brief whether the timer is enabled/disabled/one-shot */
         timer::Action action = timer::OFF;
+
+        /** @brief whether deadlines are a fixed duration apart */
+        bool fixed = false;
+
+        /** @brief Lateness of the last expiry */
+        std::chrono::microseconds lateness{};
+
+        /** @brief Deadlines skipped before the last expiry */
+        uint64_t missed = 0;
 };
 
 } // namespace hwmon
@@ -0,0 +1,93 @@
+/**
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "timerwheel.hpp"
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+TimerWheel::TimerWheel(size_t slots) : slots(slots ? slots : 1)
+{
+}
+
+void TimerWheel::add(size_t id, uint64_t period, uint64_t delay)
+{
+    insert(Entry{id, period ? period : 1, 0}, delay ? delay : 1);
+}
+
+void TimerWheel::remaining(std::vector<uint64_t>& delays) const
+{
+    auto size = slots.size();
+    for (size_t s = 0; s < size; ++s)
+    {
+        // Ticks until the slot's next visit, a whole turn for the
+        // current slot.
+        auto next = (s + size - now % size) % size;
+        if (!next)
+        {
+            next = size;
+        }
+
+        for (auto& entry : slots[s])
+        {
+            if (entry.id < delays.size())
+            {
+                delays[entry.id] = next + entry.rounds * size;
+            }
+        }
+    }
+}
+
+void TimerWheel::clear()
+{
+    for (auto& slot : slots)
+    {
+        slot.clear();
+    }
+}
+
+void TimerWheel::insert(Entry entry, uint64_t delay)
+{
+    // The slot is visited (delay - 1) / size times before the
+    // visit on which the entry is due.
+    entry.rounds = (delay - 1) / slots.size();
+    slots[(now + delay) % slots.size()].push_back(entry);
+}
+
+void TimerWheel::advance(std::vector<size_t>& due)
+{
+    ++now;
+
+    auto& slot = slots[now % slots.size()];
+    expiring.swap(slot);
+
+    for (auto& entry : expiring)
+    {
+        if (entry.rounds)
+        {
+            --entry.rounds;
+            slot.push_back(entry);
+            continue;
+        }
+
+        due.push_back(entry.id);
+        insert(entry, entry.period);
+    }
+
+    expiring.clear();
+}
+
+} // namespace hwmon
+} // namespace phosphor
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace phosphor
+{
+namespace hwmon
+{
+
+/** @class TimerWheel
+ *  @brief Hashed timing wheel of periodic entries.
+ *
+ *  Entries are identified by the caller's index and have a period
+ *  in ticks.  Each call to advance() moves the wheel on one tick
+ *  and returns the entries that are due, which are rescheduled one
+ *  period later.  Only the entries hashed to the current slot are
+ *  visited, so entries with long periods cost next to nothing on
+ *  the ticks they are not due.
+ */
+class TimerWheel
+{
+    public:
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+        TimerWheel(TimerWheel&&) = default;
+        TimerWheel& operator=(TimerWheel&&) = default;
+        ~TimerWheel() = default;
+
+        /** @brief Constructs the wheel
+         *
+         *  @param[in] slots - number of slots in the wheel
+         */
+        explicit TimerWheel(size_t slots = 64);
+
+        /** @brief Add a periodic entry
+         *
+         *  @param[in] id - caller defined entry index
+         *  @param[in] period - entry period in ticks, at least one
+         *  @param[in] delay - ticks until first due, at least one
+         */
+        void add(size_t id, uint64_t period, uint64_t delay = 1);
+
+        /** @brief Get the ticks until each entry is next due
+         *
+         *  For carrying the entries' phases over to a rebuilt wheel.
+         *
+         *  @param[in,out] delays - indexed by id, set for the entries
+         *                          with an id below its size
+         */
+        void remaining(std::vector<uint64_t>& delays) const;
+
+        /** @brief Remove all entries */
+        void clear();
+
+        /** @brief Advance the wheel by one tick
+         *
+         *  @param[out] due - appended with the ids of due entries
+         */
+        void advance(std::vector<size_t>& due);
+
+    private:
+        struct Entry
+        {
+            size_t id;
+            uint64_t period;
+            /** @brief Full turns of the wheel left until due. */
+            uint64_t rounds;
+        };
+
+        /** @brief Schedule an entry a number of ticks from now. */
+        void insert(Entry entry, uint64_t delay);
+
+        /** @brief Entries, hashed on their due tick. */
+        std::vector<std::vector<Entry>> slots;
+
+        /** @brief Scratch storage for the slot being expired. */
+        std::vector<Entry> expiring;
+
+        /** @brief Ticks since the wheel was created. */
+        uint64_t now = 0;
+};
+
+} // namespace hwmon
+} // namespace phosphor